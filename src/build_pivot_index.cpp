@@ -0,0 +1,46 @@
+#include "defs.h"
+#include "pivot_table.h"
+#include "query.h"
+
+#include <chrono>
+#include <string>
+
+void printUsage()
+{
+	std::cout <<
+		"Usage: ./build_pivot_index <curve_directory> <curve_data_file> <num_pivots> <out_file>\n"
+		"\n"
+		"Chooses <num_pivots> pivot curves of the data set farthest-first and\n"
+		"writes the Fréchet distances of all curves to them to <out_file>. The\n"
+		"file starts with the number of curves and of pivots, followed by the\n"
+		"IDs of the pivots (i.e., their lines in <curve_data_file>) and one line\n"
+		"of distances to the pivots per curve.\n"
+		"\n";
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc != 5) {
+		printUsage();
+		ERROR("Wrong number of arguments passed.");
+	}
+
+	std::string curve_directory(argv[1]);
+	std::string curve_data_file(argv[2]);
+	std::size_t num_pivots = std::stoul(argv[3]);
+	std::string out_file(argv[4]);
+
+	Query query(curve_directory);
+	query.readCurveData(curve_data_file);
+
+	auto start = std::chrono::steady_clock::now();
+
+	PivotTable pivot_table;
+	pivot_table.build(query.getCurves(), num_pivots);
+	pivot_table.write(out_file);
+
+	std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+	std::cout << "Number of curves: " << pivot_table.getNumberOfCurves() << "\n";
+	std::cout << "Number of pivots: " << pivot_table.getPivots().size() << "\n";
+	std::cout << "Time: " << time.count() << " s\n";
+}
@@ -0,0 +1,51 @@
+#include "defs.h"
+#include "distance_matrix.h"
+#include "query.h"
+
+#include <chrono>
+#include <limits>
+#include <string>
+
+void printUsage()
+{
+	std::cout <<
+		"Usage: ./calc_distance_matrix <curve_directory> <curve_data_file> <out_file> [<threshold>]\n"
+		"\n"
+		"Computes the Fréchet distances of all pairs of curves in the data set and\n"
+		"writes them to <out_file>, which is memory-mapped while computing. The\n"
+		"file starts with the header \"FRDMAT01\", the number of curves n and the\n"
+		"size of a distance (both as 64 bit integers), followed by the distances\n"
+		"of the pairs (i, j) with i < j as doubles, ordered by i and then by j.\n"
+		"\n"
+		"If a threshold is passed, the distances larger than the threshold are\n"
+		"not computed but stored as infinity.\n"
+		"\n";
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc <= 3 || argc >= 6) {
+		printUsage();
+		ERROR("Wrong number of arguments passed.");
+	}
+
+	std::string curve_directory(argv[1]);
+	std::string curve_data_file(argv[2]);
+	std::string out_file(argv[3]);
+
+	Query query(curve_directory);
+	query.readCurveData(curve_data_file);
+
+	auto start = std::chrono::steady_clock::now();
+
+	DistanceMatrix matrix(query.getCurves(), out_file);
+	if (argc == 5) {
+		matrix.setThreshold(std::stod(argv[4]));
+	}
+	matrix.compute();
+
+	std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+	std::cout << "Number of curves: " << matrix.size() << "\n";
+	std::cout << "Pairs skipped by the threshold: " << matrix.getNumberOfSkippedPairs() << "\n";
+	std::cout << "Time: " << time.count() << " s\n";
+}
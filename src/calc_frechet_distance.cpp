@@ -8,16 +8,30 @@
 void printUsage()
 {
 	std::cout <<
-		"Usage: ./test_curves <curve_file1> <curve_file2> [<out_svg_file>]\n"
+		"Usage: ./calc_frechet_distance [--rel-eps <rel_eps>] <curve_file1> <curve_file2> [<out_svg_file>]\n"
 		"\n"
 		"The third is optional. If only two arguments are passed, then no svg file\n"
 		"is exported. More information regarding the format of the curve files can\n"
 		"be found in README.\n"
+		"\n"
+		"With --rel-eps, the distance is only approximated up to a factor of\n"
+		"1+<rel_eps> and a lower and an upper bound are printed.\n"
 		"\n";
 }
 
 int main(int argc, char* argv[])
 {
+	distance_t rel_eps = 0.;
+	if (argc >= 2 && std::string(argv[1]) == "--rel-eps") {
+		if (argc <= 2) {
+			printUsage();
+			ERROR("Missing value of --rel-eps.");
+		}
+		rel_eps = std::stod(argv[2]);
+		argc -= 2;
+		argv += 2;
+	}
+
 	if (argc <= 2 || argc >= 5) {
 		printUsage();
 		ERROR("Wrong number of arguments passed.");
@@ -31,8 +45,15 @@ int main(int argc, char* argv[])
 	auto curve2 = parser::readCurve(curve_file2);
 
 	FrechetLight frechet;
-	auto distance = frechet.calcDistance(curve1, curve2);
-	std::cout << "The Fréchet distance is: " << std::setprecision(20) << distance << "\n";
+	if (rel_eps > 0.) {
+		auto bounds = frechet.calcDistanceApprox(curve1, curve2, rel_eps);
+		std::cout << "The Fréchet distance is in: [" << std::setprecision(20)
+			<< bounds.begin << ", " << bounds.end << "]\n";
+	}
+	else {
+		auto distance = frechet.calcDistance(curve1, curve2);
+		std::cout << "The Fréchet distance is: " << std::setprecision(20) << distance << "\n";
+	}
 
 	if (!vis_file.empty()) {
 		FreespaceLightVis vis(frechet);
@@ -15,27 +15,31 @@
 		}																\
 	} while (0)
 
-void Certificate::dump_certificate() const {
+template <typename T>
+void BasicCertificate<T>::dump_certificate() const {
 	std::cout << "CERTIFICATE DUMP:" << std::endl;
 	for (size_t t = 0; t < traversal.size(); t++) {
 		std::cout << t << ": (" << traversal[t][0].to_string() << ", " << traversal[t][1].to_string() << ")" << std::endl;
 	}
 }
 
-bool Certificate::feasible(const CPosition & pt) const {
+template <typename T>
+bool BasicCertificate<T>::feasible(const CPosition & pt) const {
 	return feasible(pt[0], pt[1]);
 }
 
-bool Certificate::feasible(const CPoint & pt1, const CPoint & pt2) const {
+template <typename T>
+bool BasicCertificate<T>::feasible(const CPoint & pt1, const CPoint & pt2) const {
 	return curve_pair[0]->interpolate_at(pt1).dist_sqr(curve_pair[1]->interpolate_at(pt2)) <= dist_sqr;
 }	
 
 //checks whether segment [start_pt, end_pt] on variable_curve, is non_empty at fixed_point on fixed_curve
-bool Certificate::nonEmpty(CurveID fixed_curve, const CPoint& fixed_point, const CPoint& start_pt, const CPoint& end_point) const {
+template <typename T>
+bool BasicCertificate<T>::nonEmpty(CurveID fixed_curve, const CPoint& fixed_point, const CPoint& start_pt, const CPoint& end_point) const {
 	Point fixed = curve_pair[fixed_curve]->interpolate_at(fixed_point);
 	Point start = curve_pair[1-fixed_curve]->interpolate_at(start_pt);
 	Point end = curve_pair[1-fixed_curve]->interpolate_at(end_point);
-	Interval interval = IntersectionAlgorithm::intersection_interval(fixed, dist, start, end);
+	auto interval = BasicIntersectionAlgorithm<T>::intersection_interval(fixed, dist, start, end);
 	if (!interval.is_empty()) {
 		std::cout << "free is [" << interval.begin << ", " << interval.end << "]" << std::endl;
 		std::cout << "fixed: " << fixed << std::endl;
@@ -46,20 +50,23 @@ bool Certificate::nonEmpty(CurveID fixed_curve, const CPoint& fixed_point, const
 	return interval.is_empty();
 }
 
-CPoint nextIntegralPoint(const CPoint& point) {
-	return CPoint(point.getPoint()+1, 0.); 
+template <typename T>
+BasicCPoint<T> nextIntegralPoint(const BasicCPoint<T>& point) {
+	return BasicCPoint<T>(point.getPoint()+1, 0.); 
 }
 
-CPoint prevIntegralPoint(const CPoint& point) {
+template <typename T>
+BasicCPoint<T> prevIntegralPoint(const BasicCPoint<T>& point) {
 	if (point.getFraction() > 0) {
-		return CPoint(point.getPoint(), 0.);
+		return BasicCPoint<T>(point.getPoint(), 0.);
 	} else {
-		return CPoint(point.getPoint()-1, 0.); 
+		return BasicCPoint<T>(point.getPoint()-1, 0.); 
 	}
 }
 
 
-bool Certificate::check() const {
+template <typename T>
+bool BasicCertificate<T>::check() const {
 
 	auto& curve1 = *curve_pair[0]; 
 	auto& curve2 = *curve_pair[1]; 
@@ -70,12 +77,12 @@ bool Certificate::check() const {
 	}
 
 	if (lessThan) {
-		size_t T = traversal.size();
+		size_t length = traversal.size();
 
 		CHECK(traversal[0][0] == 0 and traversal[0][1] == 0, "start point incorrect");
 		CHECK(feasible(traversal[0]), "start point not feasible");
-		CHECK(traversal[T-1][0] == curve1.size()-1 and traversal[T-1][1] == curve2.size()-1, "end point incorrect");
-		CHECK(feasible(traversal[T-1]), "end point not feasible");
+		CHECK(traversal[length-1][0] == curve1.size()-1 and traversal[length-1][1] == curve2.size()-1, "end point incorrect");
+		CHECK(feasible(traversal[length-1]), "end point not feasible");
 
 		for (size_t t = 1; t < traversal.size(); t++) {
 			CHECK(feasible(traversal[t]), "Start point of " + std::to_string(t) + "-th segement is non-feasible"); 
@@ -99,14 +106,14 @@ bool Certificate::check() const {
 		}	
 		return true;
 	} else {
-		size_t T = traversal.size();
+		size_t length = traversal.size();
 
 		CHECK(traversal[0][0] == curve1.size() -1  or traversal[0][1] == 0, "start point does not lie on the lower or right boundary");
 		CHECK(not feasible(traversal[0]), "start point is free");
-		CHECK(traversal[T-1][0] == 0 or traversal[T-1][1] == curve2.size()-1, "end point does not lie on the upper or left boundary");
-		CHECK(not feasible(traversal[T-1]), "end point is free");
+		CHECK(traversal[length-1][0] == 0 or traversal[length-1][1] == curve2.size()-1, "end point does not lie on the upper or left boundary");
+		CHECK(not feasible(traversal[length-1]), "end point is free");
 
-		for (size_t t = 1; t < T; t++) {
+		for (size_t t = 1; t < length; t++) {
 			//std::cout << "part " << t << std::endl;
 			if (traversal[t][0] >= traversal[t-1][0] and traversal[t][1] <= traversal[t-1][1]) {
 				continue;
@@ -140,3 +147,6 @@ bool Certificate::check() const {
 		return true;
 	}
 }
+
+template class BasicCertificate<float>;
+template class BasicCertificate<double>;
@@ -6,10 +6,18 @@
 
 #ifdef CERTIFY
 
-class Certificate
+template <typename T>
+class BasicCertificate
 {
 public:
-	Certificate() = default;
+	using distance_t = T;
+	using Point = BasicPoint<T>;
+	using Curve = BasicCurve<T>;
+	using CPoint = BasicCPoint<T>;
+	using CPosition = BasicCPosition<T>;
+	using CPositions = BasicCPositions<T>;
+
+	BasicCertificate() = default;
 
 	bool isYes() const { 
 		assert(isValid());
@@ -49,10 +57,13 @@ private:
 
 #else //define certificate class that offers access to dummy methods that do nothing
 
-class Certificate
+template <typename T>
+class BasicCertificate
 {
 public:
-	Certificate() = default;
+	using CPosition = BasicCPosition<T>;
+
+	BasicCertificate() = default;
 
 
 
@@ -65,4 +76,6 @@ public:
 
 #endif //CERTIFY
 
+using Certificate = BasicCertificate<distance_t>;
+
 
@@ -66,6 +66,7 @@ int main(int argc, char* argv[])
 	query.readCurveData(curve_data_file);
 	query.getReady();
 	FrechetLight frechet;
+	distance_t const ranking_rel_eps = 1e-3;
 
 	std::size_t log_n = log2(query.getCurves().size());
 	std::vector<std::size_t> ks(log_n);
@@ -92,8 +93,9 @@ int main(int argc, char* argv[])
 		std::vector<std::pair<double, CurveID>> distance_curve_pairs;
 		for (std::size_t curve_id = 0; curve_id < query.getCurves().size(); ++curve_id) {
 			auto curve = query.getCurves()[curve_id];
-			auto distance = frechet.calcDistance(curve1, curve);
-			distance_curve_pairs.emplace_back(distance, curve_id);
+			// the ranking only selects the curves, so approximate distances suffice
+			auto bounds = frechet.calcDistanceApprox(curve1, curve, ranking_rel_eps);
+			distance_curve_pairs.emplace_back((bounds.begin + bounds.end)/2., curve_id);
 		}
 		std::sort(distance_curve_pairs.begin(), distance_curve_pairs.end());
 
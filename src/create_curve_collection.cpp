@@ -0,0 +1,41 @@
+#include "defs.h"
+#include "parser.h"
+#include "query.h"
+
+#include <chrono>
+#include <string>
+
+void printUsage()
+{
+	std::cout <<
+		"Usage: ./create_curve_collection <curve_directory> <curve_data_file> <collection_file>\n"
+		"\n"
+		"Reads the data set, i.e., the curve files listed in <curve_data_file>,\n"
+		"and writes all curves to the single <collection_file>. Each line of it\n"
+		"is a point: the filename of its curve, its x and its y coordinate. Pass\n"
+		"it to ./frechet with --collection instead of <curve_data_file> to read\n"
+		"the data set without opening a file per curve.\n"
+		"\n";
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc != 4) {
+		printUsage();
+		ERROR("Wrong number of arguments passed.");
+	}
+
+	std::string curve_directory(argv[1]);
+	std::string curve_data_file(argv[2]);
+	std::string collection_file(argv[3]);
+
+	auto start = std::chrono::steady_clock::now();
+
+	Query query(curve_directory);
+	query.readCurveData(curve_data_file);
+	parser::writeCurveCollection(collection_file, query.getCurves());
+
+	std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+	std::cout << "Number of curves: " << query.getCurves().size() << "\n";
+	std::cout << "Time: " << time.count() << " s\n";
+}
@@ -1,10 +1,15 @@
 #include "curve.h"
 
-Curve::Curve(const Points& points)
+#include <utility>
+
+template <typename T>
+BasicCurve<T>::BasicCurve(const Points& points)
 	: points(points), prefix_length(points.size())
 {
+	updateView();
 	if (points.empty()) { return; }
 
+	auto& extreme_points = this->extreme_points;
 	auto const& front = points.front();
 	extreme_points = { front.x, front.y, front.x, front.y };
 	prefix_length[0] = 0;
@@ -21,8 +26,74 @@ Curve::Curve(const Points& points)
 	}
 }
 
-void Curve::push_back(Point const& point)
+template <typename T>
+BasicCurve<T>::BasicCurve(Points points, std::vector<distance_t> prefix_length,
+		ExtremePoints const& extreme_points)
+	: points(std::move(points))
+	, prefix_length(std::move(prefix_length))
+{
+	assert(this->points.size() == this->prefix_length.size());
+	this->extreme_points = extreme_points;
+	updateView();
+}
+
+template <typename T>
+BasicCurve<T>::BasicCurve(BasicCurve const& other)
+	: BasicCurveView<T>(other)
+	, filename(other.filename)
+	, points(other.begin(), other.end())
+	, prefix_length(other.getPrefixLengths(), other.getPrefixLengths() + other.size())
+{
+	updateView();
+}
+
+template <typename T>
+BasicCurve<T>::BasicCurve(BasicCurve&& other) noexcept
+	: BasicCurveView<T>(other)
+	, filename(std::move(other.filename))
+	, points(std::move(other.points))
+	, prefix_length(std::move(other.prefix_length))
+{
+	// the memory did not move, so the view is still valid
+	static_cast<BasicCurveView<T>&>(other) = BasicCurveView<T>();
+	other.points.clear();
+	other.prefix_length.clear();
+}
+
+template <typename T>
+auto BasicCurve<T>::operator=(BasicCurve const& other) -> BasicCurve&
+{
+	if (this != &other) {
+		BasicCurveView<T>::operator=(other);
+		filename = other.filename;
+		points.assign(other.begin(), other.end());
+		prefix_length.assign(other.getPrefixLengths(), other.getPrefixLengths() + other.size());
+		updateView();
+	}
+	return *this;
+}
+
+template <typename T>
+auto BasicCurve<T>::operator=(BasicCurve&& other) noexcept -> BasicCurve&
 {
+	if (this != &other) {
+		BasicCurveView<T>::operator=(other);
+		filename = std::move(other.filename);
+		points = std::move(other.points);
+		prefix_length = std::move(other.prefix_length);
+
+		static_cast<BasicCurveView<T>&>(other) = BasicCurveView<T>();
+		other.points.clear();
+		other.prefix_length.clear();
+	}
+	return *this;
+}
+
+template <typename T>
+void BasicCurve<T>::push_back(Point const& point)
+{
+	makeOwning();
+
 	if (prefix_length.size()) {
 		auto segment_distance = points.back().dist(point);
 		prefix_length.push_back(prefix_length.back() + segment_distance);
@@ -31,20 +102,44 @@ void Curve::push_back(Point const& point)
 		prefix_length.push_back(0);
 	}
 
+	auto& extreme_points = this->extreme_points;
 	extreme_points.min_x = std::min(extreme_points.min_x, point.x);
 	extreme_points.min_y = std::min(extreme_points.min_y, point.y);
 	extreme_points.max_x = std::max(extreme_points.max_x, point.x);
 	extreme_points.max_y = std::max(extreme_points.max_y, point.y);
 
 	points.push_back(point);
+	updateView();
+}
+
+template <typename T>
+void BasicCurve<T>::useStorage(BasicCurveView<T> const& storage)
+{
+	BasicCurveView<T>::operator=(storage);
+	Points().swap(this->points);
+	std::vector<distance_t>().swap(this->prefix_length);
 }
 
-auto Curve::getExtremePoints() const -> ExtremePoints const&
+template <typename T>
+void BasicCurve<T>::updateView()
 {
-	return extreme_points;
+	this->points_data = points.data();
+	this->prefix_length_data = prefix_length.data();
+	this->num_points = points.size();
 }
 
-distance_t Curve::getUpperBoundDistance(Curve const& other) const
+template <typename T>
+void BasicCurve<T>::makeOwning()
+{
+	if (ownsStorage()) { return; }
+
+	points.assign(this->begin(), this->end());
+	prefix_length.assign(this->prefix_length_data, this->prefix_length_data + this->num_points);
+	updateView();
+}
+
+template <typename T>
+T BasicCurveView<T>::getUpperBoundDistance(BasicCurveView const& other) const
 {
 	auto const& extreme1 = this->getExtremePoints();
 	auto const& extreme2 = other.getExtremePoints();
@@ -57,7 +152,8 @@ distance_t Curve::getUpperBoundDistance(Curve const& other) const
 	return min_point.dist(max_point);
 }
 
-std::ostream& operator<<(std::ostream& out, const Curve& curve)
+template <typename T>
+std::ostream& operator<<(std::ostream& out, const BasicCurveView<T>& curve)
 {
     out << "[";
 	for (auto const& point: curve) {
@@ -67,3 +163,10 @@ std::ostream& operator<<(std::ostream& out, const Curve& curve)
 
     return out;
 }
+
+template class BasicCurveView<float>;
+template class BasicCurveView<double>;
+template class BasicCurve<float>;
+template class BasicCurve<double>;
+template std::ostream& operator<<(std::ostream& out, const BasicCurveView<float>& curve);
+template std::ostream& operator<<(std::ostream& out, const BasicCurveView<double>& curve);
@@ -4,49 +4,108 @@
 #include "geometry_basics.h"
 #include "id.h"
 
-// Represents a trajectory. Additionally to the points given in the input file,
-// we also store the length of any prefix of the trajectory.
-class Curve
+// A trajectory in memory which the view does not own: its points, the length
+// of any prefix of it, and its extreme points. It is the base of BasicCurve,
+// which owns its memory, and is also used for curves whose points lie in a
+// memory block of a whole data set, see BasicCurveArena.
+template <typename T>
+class BasicCurveView
 {
 public:
-    Curve() = default;
-    Curve(const Points& points);
+	using distance_t = T;
+	using Point = BasicPoint<T>;
+	using Points = BasicPoints<T>;
+	using CPoint = BasicCPoint<T>;
+
+	struct ExtremePoints { distance_t min_x, min_y, max_x, max_y; };
 
-    std::size_t size() const { return points.size(); }
-	bool empty() const { return points.empty(); }
-    Point const& operator[](PointID i) const { return points[i]; }
+	BasicCurveView() = default;
+	BasicCurveView(Point const* points, distance_t const* prefix_length, std::size_t size,
+		ExtremePoints const& extreme_points)
+		: points_data(points), prefix_length_data(prefix_length), num_points(size)
+		, extreme_points(extreme_points) {}
+
+	std::size_t size() const { return num_points; }
+	bool empty() const { return num_points == 0; }
+	Point const& operator[](PointID i) const { return points_data[i]; }
 	Point interpolate_at(CPoint const& pt) const  {
 		assert(pt.getFraction() >= 0. && pt.getFraction() <= 1.);
-		assert((pt.getPoint() < points.size()-1 || (pt.getPoint() == points.size()-1 && pt.getFraction() == 0.)));
-		return pt.getFraction() == 0. ? points[pt.getPoint()] : points[pt.getPoint()]*(1.-pt.getFraction()) + points[pt.getPoint()+1]*pt.getFraction();
+		assert((pt.getPoint() < num_points-1 || (pt.getPoint() == num_points-1 && pt.getFraction() == 0.)));
+		return pt.getFraction() == 0. ? points_data[pt.getPoint()] : points_data[pt.getPoint()]*(1.-pt.getFraction()) + points_data[pt.getPoint()+1]*pt.getFraction();
 	}
-    distance_t curve_length(PointID i, PointID j) const
-		{ return prefix_length[j] - prefix_length[i]; }
+	distance_t curve_length(PointID i, PointID j) const
+		{ return prefix_length_data[j] - prefix_length_data[i]; }
+
+	Point front() const { return points_data[0]; }
+	Point back() const { return points_data[num_points - 1]; }
 
-    Point front() const { return points.front(); }
-    Point back() const { return points.back(); }
+	Point const* begin() const { return points_data; }
+	Point const* end() const { return points_data + num_points; }
+
+	distance_t const* getPrefixLengths() const { return prefix_length_data; }
+	ExtremePoints const& getExtremePoints() const { return extreme_points; }
+	distance_t getUpperBoundDistance(BasicCurveView const& other) const;
+
+protected:
+	Point const* points_data = nullptr;
+	distance_t const* prefix_length_data = nullptr;
+	std::size_t num_points = 0;
+	ExtremePoints extreme_points = {
+		std::numeric_limits<distance_t>::max(), std::numeric_limits<distance_t>::max(),
+		std::numeric_limits<distance_t>::lowest(), std::numeric_limits<distance_t>::lowest()
+	};
+};
+
+// Represents a trajectory. Additionally to the points given in the input file,
+// we also store the length of any prefix of the trajectory.
+//
+// A curve usually owns its points, but it can also be a view of memory which
+// is owned by someone else (see useStorage). Copying a curve always gives one
+// which owns its points, moving keeps the memory where it is.
+template <typename T>
+class BasicCurve : public BasicCurveView<T>
+{
+public:
+	using typename BasicCurveView<T>::distance_t;
+	using typename BasicCurveView<T>::Point;
+	using typename BasicCurveView<T>::Points;
+	using typename BasicCurveView<T>::CPoint;
+	using typename BasicCurveView<T>::ExtremePoints;
+
+    BasicCurve() = default;
+    BasicCurve(const Points& points);
+	// for curves whose prefix lengths and extreme points are already known,
+	// e.g., from a snapshot
+	BasicCurve(Points points, std::vector<distance_t> prefix_length, ExtremePoints const& extreme_points);
+
+	BasicCurve(BasicCurve const& other);
+	BasicCurve(BasicCurve&& other) noexcept;
+	BasicCurve& operator=(BasicCurve const& other);
+	BasicCurve& operator=(BasicCurve&& other) noexcept;
 
     void push_back(Point const& point);
 
-	Points::const_iterator begin() { return points.begin(); }
-	Points::const_iterator end() { return points.end(); }
-	Points::const_iterator begin() const { return points.cbegin(); }
-	Points::const_iterator end() const { return points.cend(); }
-	
-	std::string filename;
+	// Makes the curve the given view, e.g., of a copy of its points in a
+	// BasicCurveArena, and frees its own memory. The memory of the view has to
+	// outlive the curve and its moved versions.
+	void useStorage(BasicCurveView<T> const& storage);
+	bool ownsStorage() const { return this->points_data == points.data(); }
 
-	struct ExtremePoints { distance_t min_x, min_y, max_x, max_y; };
-	ExtremePoints const& getExtremePoints() const;
-	distance_t getUpperBoundDistance(Curve const& other) const;
+	std::string filename;
 
 private:
     Points points;
     std::vector<distance_t> prefix_length;
-	ExtremePoints extreme_points = {
-		std::numeric_limits<distance_t>::max(), std::numeric_limits<distance_t>::max(),
-		std::numeric_limits<distance_t>::lowest(), std::numeric_limits<distance_t>::lowest()
-	};
+
+	void updateView();
+	void makeOwning();
 };
-using Curves = std::vector<Curve>;
+template <typename T>
+using BasicCurves = std::vector<BasicCurve<T>>;
+
+using CurveView = BasicCurveView<distance_t>;
+using Curve = BasicCurve<distance_t>;
+using Curves = BasicCurves<distance_t>;
 
-std::ostream& operator<<(std::ostream& out, const Curve& curve);
+template <typename T>
+std::ostream& operator<<(std::ostream& out, const BasicCurveView<T>& curve);
@@ -0,0 +1,136 @@
+#include "curve_arena.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+std::uint32_t hilbertKey(std::uint32_t x, std::uint32_t y)
+{
+	std::uint32_t const n = 1u << 16;
+	std::uint32_t key = 0;
+	for (std::uint32_t s = n/2; s > 0; s /= 2) {
+		std::uint32_t const rx = (x & s) > 0;
+		std::uint32_t const ry = (y & s) > 0;
+		key += s*s*((3*rx) ^ ry);
+
+		// rotate the quadrant such that the curve continues
+		if (ry == 0) {
+			if (rx == 1) {
+				x = n - 1 - x;
+				y = n - 1 - y;
+			}
+			std::swap(x, y);
+		}
+	}
+	return key;
+}
+
+template <typename T>
+void BasicCurveArena<T>::pack(Curves& curves)
+{
+	// the bounding box of all curves, to which the grid of the keys is fit
+	distance_t min_x = std::numeric_limits<distance_t>::max();
+	distance_t min_y = std::numeric_limits<distance_t>::max();
+	distance_t max_x = std::numeric_limits<distance_t>::lowest();
+	distance_t max_y = std::numeric_limits<distance_t>::lowest();
+	for (auto const& curve: curves) {
+		if (curve.empty()) { continue; }
+		auto const& extreme_points = curve.getExtremePoints();
+		min_x = std::min(min_x, extreme_points.min_x);
+		min_y = std::min(min_y, extreme_points.min_y);
+		max_x = std::max(max_x, extreme_points.max_x);
+		max_y = std::max(max_y, extreme_points.max_y);
+	}
+
+	auto grid = [](distance_t value, distance_t min, distance_t max) -> std::uint32_t {
+		if (!(max > min)) { return 0; }
+		auto const cell = (value - min)/(max - min)*((1 << 16) - 1);
+		return static_cast<std::uint32_t>(std::max<distance_t>(0, std::min<distance_t>(cell, (1 << 16) - 1)));
+	};
+
+	std::vector<std::uint32_t> keys(curves.size());
+	std::size_t num_new_points = 0;
+	for (CurveID id = 0; id < curves.size(); ++id) {
+		auto const& extreme_points = curves[id].getExtremePoints();
+		auto const center_x = (extreme_points.min_x + extreme_points.max_x)/2;
+		auto const center_y = (extreme_points.min_y + extreme_points.max_y)/2;
+		keys[id] = curves[id].empty() ? 0 : hilbertKey(grid(center_x, min_x, max_x), grid(center_y, min_y, max_y));
+		num_new_points += curves[id].size();
+	}
+
+	CurveIDs order(curves.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&](CurveID id1, CurveID id2) {
+		return keys[id1] < keys[id2] || (keys[id1] == keys[id2] && id1 < id2);
+	});
+
+	// fill new blocks first, as the curves may still be views of the old ones
+	Points new_points;
+	std::vector<distance_t> new_prefix_lengths;
+	new_points.reserve(num_new_points);
+	new_prefix_lengths.reserve(num_new_points);
+	for (auto id: order) {
+		auto const& curve = curves[id];
+		new_points.insert(new_points.end(), curve.begin(), curve.end());
+		new_prefix_lengths.insert(new_prefix_lengths.end(), curve.getPrefixLengths(), curve.getPrefixLengths() + curve.size());
+	}
+
+	std::size_t offset = 0;
+	for (auto id: order) {
+		auto& curve = curves[id];
+		curve.useStorage(BasicCurveView<T>(new_points.data() + offset, new_prefix_lengths.data() + offset,
+			curve.size(), curve.getExtremePoints()));
+		offset += curve.size();
+	}
+
+	// moving a vector keeps its memory, so the views stay valid
+	points = std::move(new_points);
+	prefix_lengths = std::move(new_prefix_lengths);
+	points_data = points.data();
+	prefix_lengths_data = prefix_lengths.data();
+	num_points = points.size();
+}
+
+template <typename T>
+void BasicCurveArena<T>::assign(Point const* new_points, distance_t const* new_prefix_lengths,
+	std::size_t new_num_points, std::uint64_t const* offsets, std::uint64_t const* sizes, Curves& curves)
+{
+	for (CurveID id = 0; id < curves.size(); ++id) {
+		assert(offsets[id] + sizes[id] <= new_num_points);
+		auto& curve = curves[id];
+		curve.useStorage(BasicCurveView<T>(new_points + offsets[id], new_prefix_lengths + offsets[id],
+			sizes[id], curve.getExtremePoints()));
+	}
+
+	clear();
+	points_data = new_points;
+	prefix_lengths_data = new_prefix_lengths;
+	num_points = new_num_points;
+}
+
+template <typename T>
+void BasicCurveArena<T>::clear()
+{
+	Points().swap(points);
+	std::vector<distance_t>().swap(prefix_lengths);
+	points_data = nullptr;
+	prefix_lengths_data = nullptr;
+	num_points = 0;
+}
+
+template <typename T>
+bool BasicCurveArena<T>::contains(Curve const& curve) const
+{
+	return !curve.empty() && curve.begin() >= points_data && curve.end() <= points_data + num_points;
+}
+
+template <typename T>
+std::size_t BasicCurveArena<T>::getOffset(Curve const& curve) const
+{
+	assert(curve.empty() || contains(curve));
+	return curve.empty() ? 0 : curve.begin() - points_data;
+}
+
+template class BasicCurveArena<float>;
+template class BasicCurveArena<double>;
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "defs.h"
+#include "geometry_basics.h"
+#include "curves.h"
+
+#include <cstdint>
+#include <vector>
+
+// One contiguous block of memory for the points and one for the prefix
+// lengths of all curves of a data set, instead of two allocations per curve.
+// The curves are placed in the order of their bounding box centers along a
+// Hilbert curve, so curves which are close in the plane, and thus likely
+// candidates of the same query, are also close in memory. The curves stay
+// where they are in their vector, so their IDs do not change; they just
+// become views of the arena.
+//
+// The blocks are either owned by the arena or, for data sets from a
+// snapshot, the arrays in the mapped file, which are then used in place.
+template <typename T>
+class BasicCurveArena
+{
+public:
+	using distance_t = T;
+	using Curve = BasicCurve<T>;
+	using Curves = BasicCurves<T>;
+	using Point = BasicPoint<T>;
+	using Points = BasicPoints<T>;
+
+	BasicCurveArena() = default;
+	// the curves point into the arena, so it must not be copied
+	BasicCurveArena(BasicCurveArena const&) = delete;
+	BasicCurveArena& operator=(BasicCurveArena const&) = delete;
+
+	// Copies the points and prefix lengths of the curves into the arena and
+	// makes the curves views of it. The curves may be views of this arena.
+	void pack(Curves& curves);
+	// Uses blocks of num_points points and prefix lengths which are already
+	// in arena order, e.g., in a mapped snapshot, as arena without copying
+	// them, so they have to outlive the arena. The points of the curve with
+	// ID id start at offsets[id]; the curves need their extreme points, which
+	// are not part of the blocks.
+	void assign(Point const* points, distance_t const* prefix_lengths, std::size_t num_points,
+		std::uint64_t const* offsets, std::uint64_t const* sizes, Curves& curves);
+	void clear();
+
+	Point const* getPoints() const { return points_data; }
+	distance_t const* getPrefixLengths() const { return prefix_lengths_data; }
+	std::size_t getNumberOfPoints() const { return num_points; }
+	// the position of the first point of a curve in the arena
+	std::size_t getOffset(Curve const& curve) const;
+	bool contains(Curve const& curve) const;
+
+private:
+	// the blocks if the arena owns them
+	Points points;
+	std::vector<distance_t> prefix_lengths;
+
+	Point const* points_data = nullptr;
+	distance_t const* prefix_lengths_data = nullptr;
+	std::size_t num_points = 0;
+};
+
+// The position of (x, y) in [0, 2^16)^2 along the Hilbert curve.
+std::uint32_t hilbertKey(std::uint32_t x, std::uint32_t y);
+
+using CurveArena = BasicCurveArena<distance_t>;
@@ -0,0 +1,294 @@
+#include "distance_matrix.h"
+
+#include "frechet_light.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+namespace
+{
+
+char const magic[8] = {'F', 'R', 'D', 'M', 'A', 'T', '0', '1'};
+
+struct Header
+{
+	char magic[8];
+	uint64_t num_curves;
+	uint64_t scalar_size;
+};
+
+} // end anonymous namespace
+
+template <typename T>
+BasicDistanceMatrix<T>::BasicDistanceMatrix(Curves const& curves)
+	: curves(curves)
+	, num_entries(curves.size()*(curves.size()-1)/2)
+	, entries_vector(num_entries)
+	, entries(entries_vector.data())
+{
+}
+
+template <typename T>
+BasicDistanceMatrix<T>::BasicDistanceMatrix(Curves const& curves, std::string const& filename)
+	: curves(curves)
+	, num_entries(curves.size()*(curves.size()-1)/2)
+{
+	mapping_size = sizeof(Header) + num_entries*sizeof(distance_t);
+
+	int fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd == -1) {
+		ERROR("The distance matrix file could not be opened: " << filename);
+	}
+	if (ftruncate(fd, mapping_size) != 0) {
+		ERROR("The distance matrix file could not be resized: " << filename);
+	}
+	mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED) {
+		ERROR("The distance matrix file could not be mapped: " << filename);
+	}
+
+	Header header;
+	std::memcpy(header.magic, magic, sizeof(magic));
+	header.num_curves = curves.size();
+	header.scalar_size = sizeof(distance_t);
+	std::memcpy(mapping, &header, sizeof(Header));
+
+	entries = reinterpret_cast<distance_t*>(static_cast<char*>(mapping) + sizeof(Header));
+}
+
+template <typename T>
+BasicDistanceMatrix<T>::~BasicDistanceMatrix()
+{
+	if (mapping != nullptr) {
+		munmap(mapping, mapping_size);
+	}
+}
+
+template <typename T>
+void BasicDistanceMatrix<T>::setThreshold(distance_t threshold)
+{
+	this->threshold = threshold;
+}
+
+template <typename T>
+void BasicDistanceMatrix<T>::setTileSize(std::size_t tile_size)
+{
+	assert(tile_size >= 1);
+	this->tile_size = tile_size;
+}
+
+template <typename T>
+void BasicDistanceMatrix<T>::compute()
+{
+	num_skipped_pairs = 0;
+	if (curves.size() <= 1) { return; }
+
+	computeOrder();
+
+	// the tiles are the blocks of tile_size consecutive curves in the order
+	auto const num_blocks = (curves.size() + tile_size - 1)/tile_size;
+	auto block_begin = [&](std::size_t block) { return block*tile_size; };
+	auto block_end = [&](std::size_t block) { return std::min((block + 1)*tile_size, curves.size()); };
+
+	std::vector<FeatureBox> feature_boxes;
+	std::vector<double> block_sizes;
+	for (std::size_t block = 0; block < num_blocks; ++block) {
+		feature_boxes.push_back(getFeatureBox(block_begin(block), block_end(block)));
+		block_sizes.push_back(0.);
+		for (std::size_t i = block_begin(block); i < block_end(block); ++i) {
+			block_sizes.back() += curves[order[i]].size();
+		}
+	}
+
+	auto skip = [&](std::size_t i, std::size_t j) {
+		entries[index(order[i], order[j])] = above_threshold;
+		++num_skipped_pairs;
+	};
+
+	std::vector<Tile> tiles;
+	for (std::size_t row = 0; row < num_blocks; ++row) {
+		for (std::size_t column = row; column < num_blocks; ++column) {
+			if (lowerBound(feature_boxes[row], feature_boxes[column]) > threshold) {
+				for (std::size_t i = block_begin(row); i < block_end(row); ++i) {
+					for (std::size_t j = std::max(i+1, block_begin(column)); j < block_end(column); ++j) {
+						skip(i, j);
+					}
+				}
+				continue;
+			}
+			// the decider is roughly linear in the curve sizes
+			double cost = block_sizes[row]*block_sizes[column];
+			tiles.push_back({row, column, row == column ? cost/2 : cost});
+		}
+	}
+	std::sort(tiles.begin(), tiles.end(), [](Tile const& tile1, Tile const& tile2) {
+		return tile1.cost > tile2.cost;
+	});
+
+	std::size_t num_skipped_in_tiles = 0;
+#ifdef WITH_OPENMP
+	#pragma omp parallel reduction(+: num_skipped_in_tiles)
+#endif
+	{
+		BasicFrechetLight<T> light;
+
+#ifdef WITH_OPENMP
+		#pragma omp for schedule(dynamic, 1)
+#endif
+		for (std::size_t t = 0; t < tiles.size(); ++t) {
+			auto const& tile = tiles[t];
+			for (std::size_t i = block_begin(tile.row); i < block_end(tile.row); ++i) {
+				for (std::size_t j = std::max(i+1, block_begin(tile.column)); j < block_end(tile.column); ++j) {
+					auto const& curve1 = curves[order[i]];
+					auto const& curve2 = curves[order[j]];
+					auto& entry = entries[index(order[i], order[j])];
+
+					// the threshold bounds the search of the distance, so
+					// the pairs above it cost at most one decider call
+					if (lowerBound(features[order[i]], features[order[j]]) > threshold) {
+						entry = above_threshold;
+					}
+					else {
+						entry = light.calcDistance(curve1, curve2, threshold);
+					}
+					if (entry > threshold) {
+						entry = above_threshold;
+						++num_skipped_in_tiles;
+					}
+				}
+			}
+		}
+	}
+	num_skipped_pairs += num_skipped_in_tiles;
+}
+
+template <typename T>
+T BasicDistanceMatrix<T>::get(CurveID id1, CurveID id2) const
+{
+	if (id1 == id2) { return 0; }
+	return entries[index(id1, id2)];
+}
+
+template <typename T>
+void BasicDistanceMatrix<T>::save(std::string const& filename) const
+{
+	std::ofstream file(filename, std::ios::binary);
+	if (!file.is_open()) {
+		ERROR("The distance matrix file could not be opened: " << filename);
+	}
+
+	Header header;
+	std::memcpy(header.magic, magic, sizeof(magic));
+	header.num_curves = curves.size();
+	header.scalar_size = sizeof(distance_t);
+	file.write(reinterpret_cast<char const*>(&header), sizeof(Header));
+	file.write(reinterpret_cast<char const*>(entries), num_entries*sizeof(distance_t));
+}
+
+template <typename T>
+std::size_t BasicDistanceMatrix<T>::index(CurveID id1, CurveID id2) const
+{
+	assert(id1 != id2 && id1 < curves.size() && id2 < curves.size());
+	if (id1 > id2) { std::swap(id1, id2); }
+	return id1*curves.size() - id1*(id1+1)/2 + (id2-id1-1);
+}
+
+// Orders the curves by recursively splitting them at the median of the
+// feature with the largest spread, like the build of a kd-tree, such that
+// the blocks of consecutive curves contain similar curves.
+template <typename T>
+void BasicDistanceMatrix<T>::computeOrder()
+{
+	features.clear();
+	for (auto const& curve: curves) {
+		auto const& extreme_points = curve.getExtremePoints();
+		features.push_back({{
+			curve.front().x, curve.front().y, curve.back().x, curve.back().y,
+			extreme_points.min_x, extreme_points.min_y, extreme_points.max_x, extreme_points.max_y
+		}});
+	}
+
+	order.resize(curves.size());
+	for (CurveID id = 0; id < curves.size(); ++id) {
+		order[id] = id;
+	}
+
+	std::vector<std::pair<std::size_t, std::size_t>> ranges = {{0, order.size()}};
+	while (!ranges.empty()) {
+		auto begin = ranges.back().first;
+		auto end = ranges.back().second;
+		ranges.pop_back();
+		if (end - begin <= tile_size) { continue; }
+
+		auto const box = getFeatureBox(begin, end);
+		int dimension = 0;
+		for (int d = 1; d < 8; ++d) {
+			if (box.max[d] - box.min[d] > box.max[dimension] - box.min[dimension]) {
+				dimension = d;
+			}
+		}
+
+		// split at a multiple of tile_size such that the blocks stay intact
+		auto mid = begin + ((end - begin)/2 + tile_size - 1)/tile_size*tile_size;
+		std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+			[&](CurveID id1, CurveID id2) { return features[id1][dimension] < features[id2][dimension]; });
+		ranges.emplace_back(begin, mid);
+		ranges.emplace_back(mid, end);
+	}
+}
+
+template <typename T>
+auto BasicDistanceMatrix<T>::getFeatureBox(std::size_t begin, std::size_t end) const -> FeatureBox
+{
+	FeatureBox box;
+	box.min.fill(std::numeric_limits<T>::max());
+	box.max.fill(std::numeric_limits<T>::lowest());
+	for (std::size_t i = begin; i < end; ++i) {
+		for (std::size_t d = 0; d < 8; ++d) {
+			box.min[d] = std::min(box.min[d], features[order[i]][d]);
+			box.max[d] = std::max(box.max[d], features[order[i]][d]);
+		}
+	}
+	return box;
+}
+
+// The start points, the end points, and the sides of the bounding boxes can be
+// at most the Fréchet distance apart (see isNear in query_helper.h).
+template <typename T>
+T BasicDistanceMatrix<T>::lowerBound(Features const& features1, Features const& features2)
+{
+	return lowerBound(FeatureBox{features1, features1}, FeatureBox{features2, features2});
+}
+
+template <typename T>
+T BasicDistanceMatrix<T>::lowerBound(FeatureBox const& box1, FeatureBox const& box2)
+{
+	Features gaps;
+	for (std::size_t d = 0; d < 8; ++d) {
+		gaps[d] = std::max<T>({0, box1.min[d] - box2.max[d], box2.min[d] - box1.max[d]});
+	}
+
+	distance_t bound = 0;
+	for (std::size_t d = 0; d < 4; d += 2) {
+		bound = std::max(bound, std::sqrt(gaps[d]*gaps[d] + gaps[d+1]*gaps[d+1]));
+	}
+	for (std::size_t d = 4; d < 8; ++d) {
+		bound = std::max(bound, gaps[d]);
+	}
+	return bound;
+}
+
+template class BasicDistanceMatrix<float>;
+template class BasicDistanceMatrix<double>;
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "defs.h"
+#include "geometry_basics.h"
+#include "curves.h"
+
+#include <array>
+#include <limits>
+#include <string>
+#include <vector>
+
+// The Fréchet distances of all pairs of curves of a data set. Only the upper
+// triangle is computed and stored, packed row by row, i.e., the entry of
+// (i, j) with i < j is at position i*n - i*(i+1)/2 + (j-i-1).
+//
+// The pairs are processed in square tiles which the threads take one after
+// another from a shared queue, the most expensive tiles first. The curves are
+// reordered such that similar curves end up in the same tiles; then, with a
+// threshold, whole tiles can be skipped by the bounds of their bounding boxes
+// and endpoints.
+//
+// The matrix is either kept in memory or, for large data sets, directly in a
+// memory-mapped file with the format of save.
+template <typename T>
+class BasicDistanceMatrix
+{
+public:
+	using distance_t = T;
+	using Curve = BasicCurve<T>;
+	using Curves = BasicCurves<T>;
+
+	// the entry of the pairs which are provably farther apart than the threshold
+	static constexpr distance_t above_threshold = std::numeric_limits<T>::infinity();
+
+	explicit BasicDistanceMatrix(Curves const& curves);
+	// Keeps the matrix in the given file, which is created or overwritten.
+	BasicDistanceMatrix(Curves const& curves, std::string const& filename);
+	~BasicDistanceMatrix();
+
+	BasicDistanceMatrix(BasicDistanceMatrix const& other) = delete;
+	BasicDistanceMatrix& operator=(BasicDistanceMatrix const& other) = delete;
+
+	// Only compute the distances which are at most threshold, the other
+	// entries are set to above_threshold.
+	void setThreshold(distance_t threshold);
+	// the number of rows and columns of a tile
+	void setTileSize(std::size_t tile_size);
+
+	void compute();
+
+	std::size_t size() const { return curves.size(); }
+	distance_t get(CurveID id1, CurveID id2) const;
+
+	// File format: the header ("FRDMAT01", the number of curves as 64 bit
+	// integer, sizeof(distance_t) as 64 bit integer) followed by the packed
+	// upper triangle.
+	void save(std::string const& filename) const;
+
+	// the number of pairs whose distance was not computed due to the threshold
+	std::size_t getNumberOfSkippedPairs() const { return num_skipped_pairs; }
+
+private:
+	using Features = std::array<T, 8>;
+	struct FeatureBox { Features min, max; };
+
+	struct Tile
+	{
+		std::size_t row;
+		std::size_t column;
+		double cost;
+	};
+
+	Curves const& curves;
+	std::size_t const num_entries;
+
+	distance_t threshold = above_threshold;
+	std::size_t tile_size = 64;
+	std::size_t num_skipped_pairs = 0;
+
+	// the entries are either in the vector or in the mapped file
+	std::vector<distance_t> entries_vector;
+	distance_t* entries = nullptr;
+	void* mapping = nullptr;
+	std::size_t mapping_size = 0;
+
+	// the order in which the curves are tiled
+	std::vector<CurveID> order;
+	std::vector<Features> features;
+
+	// the position of the pair in the packed upper triangle, in either order
+	std::size_t index(CurveID id1, CurveID id2) const;
+	void computeOrder();
+	FeatureBox getFeatureBox(std::size_t begin, std::size_t end) const;
+	static distance_t lowerBound(Features const& features1, Features const& features2);
+	static distance_t lowerBound(FeatureBox const& box1, FeatureBox const& box2);
+};
+
+template <typename T>
+constexpr T BasicDistanceMatrix<T>::above_threshold;
+
+using DistanceMatrix = BasicDistanceMatrix<distance_t>;
@@ -0,0 +1,244 @@
+#include "dynamic_index.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+template <typename T>
+BasicDynamicIndex<T>::BasicDynamicIndex()
+{
+	std::atomic_store(&snapshot, SnapshotPtr(std::make_shared<Snapshot const>()));
+}
+
+template <typename T>
+BasicDynamicIndex<T>::Tombstones::Tombstones(std::size_t num_entries)
+	: chunks((num_entries + tombstone_chunk_size - 1)/tombstone_chunk_size)
+{
+}
+
+template <typename T>
+bool BasicDynamicIndex<T>::Tombstones::contains(std::size_t index) const
+{
+	auto const& chunk = chunks[index/tombstone_chunk_size];
+	return chunk && chunk->test(index%tombstone_chunk_size);
+}
+
+template <typename T>
+void BasicDynamicIndex<T>::Tombstones::insert(std::size_t index)
+{
+	assert(!contains(index));
+
+	auto& chunk = chunks[index/tombstone_chunk_size];
+	auto copy = chunk ? std::make_shared<Chunk>(*chunk) : std::make_shared<Chunk>();
+	copy->set(index%tombstone_chunk_size);
+	chunk = std::move(copy);
+	++count;
+}
+
+template <typename T>
+BasicDynamicIndex<T>::Level::Level(Entries&& level_entries, std::size_t capacity)
+	: tree(kd_feature_dimension)
+	, entries(std::move(level_entries))
+	, capacity(capacity)
+{
+	// sorted by ID for the lookup in remove
+	std::sort(entries.begin(), entries.end(),
+		[](Entry const& entry1, Entry const& entry2) { return entry1.id < entry2.id; });
+
+	for (std::size_t i = 0; i < entries.size(); ++i) {
+		tree.add(entries[i].kd_point, i);
+	}
+	tree.build();
+}
+
+template <typename T>
+CurveID BasicDynamicIndex<T>::insert(Curve curve)
+{
+	Curves curves;
+	curves.push_back(std::move(curve));
+	return insert(std::move(curves)).front();
+}
+
+template <typename T>
+CurveIDs BasicDynamicIndex<T>::insert(Curves curves)
+{
+	std::lock_guard<std::mutex> lock(update_mutex);
+
+	CurveIDs ids;
+	Entries entries;
+	for (auto& curve: curves) {
+		auto kd_point = toKdPoint(curve);
+		entries.push_back({next_id, std::make_shared<Curve const>(std::move(curve)), kd_point});
+		ids.push_back(next_id++);
+	}
+
+	Snapshot next = *std::atomic_load(&snapshot);
+	next.size += entries.size();
+	insertEntries(next, std::move(entries));
+	std::atomic_store(&snapshot, SnapshotPtr(std::make_shared<Snapshot const>(std::move(next))));
+
+	return ids;
+}
+
+template <typename T>
+bool BasicDynamicIndex<T>::remove(CurveID id)
+{
+	std::lock_guard<std::mutex> lock(update_mutex);
+
+	Snapshot next = *std::atomic_load(&snapshot);
+
+	// curves in the buffer are removed right away
+	auto buffer_it = std::find_if(next.buffer.begin(), next.buffer.end(),
+		[&](Entry const& entry) { return entry.id == id; });
+	if (buffer_it != next.buffer.end()) {
+		next.buffer.erase(buffer_it);
+	}
+	else {
+		std::size_t level = 0;
+		std::size_t index = 0;
+		for (; level < next.levels.size(); ++level) {
+			index = find(next.levels[level]->entries, id);
+			if (index < next.levels[level]->entries.size()) { break; }
+		}
+		if (level == next.levels.size() || next.removed[level].contains(index)) { return false; }
+
+		next.removed[level].insert(index);
+		++next.num_removed;
+	}
+	--next.size;
+
+	if (next.num_removed > next.size) {
+		mergeAll(next);
+	}
+	std::atomic_store(&snapshot, SnapshotPtr(std::make_shared<Snapshot const>(std::move(next))));
+
+	return true;
+}
+
+template <typename T>
+void BasicDynamicIndex<T>::query(Curve const& curve, distance_t distance, FrechetLight& frechet,
+	CurveIDs& result) const
+{
+	// the snapshot stays valid while we hold it, whatever the updates do
+	auto const current = std::atomic_load(&snapshot);
+	auto const query_point = toKdPoint(curve);
+
+	typename Tree::Values candidates;
+	for (std::size_t level = 0; level < current->levels.size(); ++level) {
+		auto const& entries = current->levels[level]->entries;
+		candidates.clear();
+		current->levels[level]->tree.search(query_point, distance, candidates);
+
+		for (auto index: candidates) {
+			if (current->removed[level].contains(index)) { continue; }
+			auto const& entry = entries[index];
+			if (frechet.lessThanWithFilters(distance, curve, *entry.curve)) {
+				result.push_back(entry.id);
+			}
+		}
+	}
+
+	for (auto const& entry: current->buffer) {
+		if (!isNear<T>(query_point, entry.kd_point, distance)) { continue; }
+		if (frechet.lessThanWithFilters(distance, curve, *entry.curve)) {
+			result.push_back(entry.id);
+		}
+	}
+}
+
+template <typename T>
+std::size_t BasicDynamicIndex<T>::size() const
+{
+	return std::atomic_load(&snapshot)->size;
+}
+
+template <typename T>
+std::size_t BasicDynamicIndex<T>::getNumberOfTrees() const
+{
+	return std::atomic_load(&snapshot)->levels.size();
+}
+
+template <typename T>
+void BasicDynamicIndex<T>::insertEntries(Snapshot& next, Entries&& entries)
+{
+	std::move(entries.begin(), entries.end(), std::back_inserter(next.buffer));
+	if (next.buffer.size() < buffer_size) { return; }
+
+	Entries level_entries;
+	level_entries.swap(next.buffer);
+	auto const capacity = std::max(buffer_size, level_entries.size());
+	pushLevel(next, std::move(level_entries), capacity);
+}
+
+// Adds a level with the entries, merging it with the smaller levels as long
+// as they are not larger than the new one. The removed curves of the merged
+// levels are dropped, and so are their tombstones.
+template <typename T>
+void BasicDynamicIndex<T>::pushLevel(Snapshot& next, Entries&& entries, std::size_t capacity)
+{
+	auto& levels = next.levels;
+	std::size_t num_merged = 0;
+	while (num_merged < levels.size() && levels[num_merged]->capacity <= capacity) {
+		auto const& level = *levels[num_merged];
+		auto const& removed = next.removed[num_merged];
+		auto live = liveEntries(level.entries, removed);
+		std::move(live.begin(), live.end(), std::back_inserter(entries));
+		capacity += level.capacity;
+		next.num_removed -= removed.size();
+		++num_merged;
+	}
+	levels.erase(levels.begin(), levels.begin() + num_merged);
+	next.removed.erase(next.removed.begin(), next.removed.begin() + num_merged);
+
+	if (!entries.empty()) {
+		next.removed.emplace(next.removed.begin(), entries.size());
+		levels.insert(levels.begin(), std::make_shared<Level const>(std::move(entries), capacity));
+	}
+}
+
+// Rebuilds all levels into a single one without the removed curves. This is
+// only done when the tombstones outnumber the live curves, so it amortizes
+// over the removals.
+template <typename T>
+void BasicDynamicIndex<T>::mergeAll(Snapshot& next)
+{
+	Entries entries;
+	for (std::size_t level = 0; level < next.levels.size(); ++level) {
+		auto live = liveEntries(next.levels[level]->entries, next.removed[level]);
+		std::move(live.begin(), live.end(), std::back_inserter(entries));
+	}
+
+	next.levels.clear();
+	next.removed.clear();
+	next.num_removed = 0;
+	if (!entries.empty()) {
+		auto const capacity = std::max(buffer_size, entries.size());
+		next.removed.emplace_back(entries.size());
+		next.levels.push_back(std::make_shared<Level const>(std::move(entries), capacity));
+	}
+}
+
+template <typename T>
+auto BasicDynamicIndex<T>::liveEntries(Entries const& entries, Tombstones const& removed)
+	-> Entries
+{
+	Entries live;
+	for (std::size_t i = 0; i < entries.size(); ++i) {
+		if (!removed.contains(i)) { live.push_back(entries[i]); }
+	}
+	return live;
+}
+
+// Returns the position of the entry with the ID, or the number of entries if
+// there is none.
+template <typename T>
+std::size_t BasicDynamicIndex<T>::find(Entries const& entries, CurveID id)
+{
+	auto it = std::lower_bound(entries.begin(), entries.end(), id,
+		[](Entry const& entry, CurveID id) { return entry.id < id; });
+	if (it == entries.end() || it->id != id) { return entries.size(); }
+	return it - entries.begin();
+}
+
+template class BasicDynamicIndex<float>;
+template class BasicDynamicIndex<double>;
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "defs.h"
+#include "frechet_light.h"
+#include "geometry_basics.h"
+#include "query_helper.h"
+#include "curves.h"
+
+#include <bitset>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// A curve index which supports inserting and removing curves while queries
+// are running. It uses the logarithmic method: the curves are in a small
+// buffer, which is searched linearly, and in static kd-trees whose sizes are
+// buffer_size times powers of two. A full buffer becomes a new tree, and two
+// trees of the same size are merged into one of the next size, like the
+// carries of a binary counter. So every curve is part of O(log n) builds.
+//
+// Removed curves are tombstoned and dropped at the next merge of their tree;
+// if there are more tombstones than live curves, all trees are merged into
+// one. The tombstones of a tree are bits in chunks which the snapshots share,
+// so a removal copies one chunk and not all tombstones.
+//
+// The state of the index is an immutable snapshot. The updates build a new
+// snapshot under a mutex and publish it atomically, while each query takes
+// the snapshot which is current when it starts. So queries never wait for
+// updates, and they never see a partial update.
+template <typename T>
+class BasicDynamicIndex
+{
+public:
+	using distance_t = T;
+	using Curve = BasicCurve<T>;
+	using Curves = BasicCurves<T>;
+	using FrechetLight = BasicFrechetLight<T>;
+
+	static constexpr std::size_t buffer_size = 64;
+	static constexpr std::size_t tombstone_chunk_size = 4096;
+
+	BasicDynamicIndex();
+
+	// Returns the ID of the curve. IDs are assigned in order of insertion and
+	// are never reused.
+	CurveID insert(Curve curve);
+	// Inserts all curves with a single update of the index.
+	CurveIDs insert(Curves curves);
+	// Returns false if the curve is not in the index (anymore).
+	bool remove(CurveID id);
+
+	// Appends the IDs of all curves with Fréchet distance at most distance to
+	// result. The decider is passed in such that each thread can use its own.
+	void query(Curve const& curve, distance_t distance, FrechetLight& frechet, CurveIDs& result) const;
+
+	// the number of curves in the index, i.e., without the removed ones
+	std::size_t size() const;
+	// the number of kd-trees, for testing
+	std::size_t getNumberOfTrees() const;
+
+private:
+	using Tree = BasicTree<T>;
+	using CurvePtr = std::shared_ptr<Curve const>;
+
+	struct Entry
+	{
+		CurveID id;
+		CurvePtr curve;
+		typename Tree::Point kd_point;
+	};
+	using Entries = std::vector<Entry>;
+
+	// a kd-tree of a snapshot; the value of a point is its position in entries
+	struct Level
+	{
+		Tree tree;
+		Entries entries;
+		// the number of entries this level stands for in the binary counter
+		std::size_t capacity;
+
+		Level(Entries&& entries, std::size_t capacity);
+	};
+	using LevelPtr = std::shared_ptr<Level const>;
+
+	// the removed entries of a level, by their position in its entries
+	class Tombstones
+	{
+	public:
+		explicit Tombstones(std::size_t num_entries = 0);
+
+		bool contains(std::size_t index) const;
+		// copies the chunk of the index if it is shared
+		void insert(std::size_t index);
+		std::size_t size() const { return count; }
+
+	private:
+		using Chunk = std::bitset<tombstone_chunk_size>;
+
+		// null for chunks without tombstones
+		std::vector<std::shared_ptr<Chunk const>> chunks;
+		std::size_t count = 0;
+	};
+
+	struct Snapshot
+	{
+		Entries buffer;
+		// sorted by increasing capacity
+		std::vector<LevelPtr> levels;
+		// the tombstones of each level
+		std::vector<Tombstones> removed;
+		std::size_t num_removed = 0;
+		std::size_t size = 0;
+	};
+	using SnapshotPtr = std::shared_ptr<Snapshot const>;
+
+	// access only with std::atomic_load and std::atomic_store
+	SnapshotPtr snapshot;
+
+	std::mutex update_mutex;
+	CurveID next_id = 0;
+
+	void insertEntries(Snapshot& next, Entries&& entries);
+	void pushLevel(Snapshot& next, Entries&& entries, std::size_t capacity);
+	void mergeAll(Snapshot& next);
+	static Entries liveEntries(Entries const& entries, Tombstones const& removed);
+	static std::size_t find(Entries const& entries, CurveID id);
+};
+
+template <typename T>
+constexpr std::size_t BasicDynamicIndex<T>::buffer_size;
+template <typename T>
+constexpr std::size_t BasicDynamicIndex<T>::tombstone_chunk_size;
+
+using DynamicIndex = BasicDynamicIndex<distance_t>;
@@ -1,6 +1,7 @@
 #include "filter.h"
 
-bool Filter::isPointTooFarFromCurve(Point fixed, const Curve& curve, distance_t distance)
+template <typename T>
+bool BasicFilter<T>::isPointTooFarFromCurve(Point fixed, const Curve& curve, distance_t distance)
 {
 	auto dist_sqr = distance * distance;
 	if (fixed.dist_sqr(curve.front()) <= dist_sqr || fixed.dist_sqr(curve.back()) <= dist_sqr) { return false; }
@@ -24,7 +25,8 @@ bool Filter::isPointTooFarFromCurve(Point fixed, const Curve& curve, distance_t
 	return true;
 }
 
-bool Filter::isFree(Point const& fixed, Curve const& var_curve, PointID start, PointID end,
+template <typename T>
+bool BasicFilter<T>::isFree(Point const& fixed, Curve const& var_curve, PointID start, PointID end,
             distance_t distance)
 {
 	auto mid = (start + end + 1) / 2;
@@ -40,7 +42,8 @@ bool Filter::isFree(Point const& fixed, Curve const& var_curve, PointID start, P
 	}
 }
 
-bool Filter::isFree(Curve const& curve1, PointID start1, PointID end1, Curve const& curve2, PointID start2, PointID end2, distance_t distance)
+template <typename T>
+bool BasicFilter<T>::isFree(Curve const& curve1, PointID start1, PointID end1, Curve const& curve2, PointID start2, PointID end2, distance_t distance)
 {
 	auto mid1 = (start1 + end1 + 1) / 2;
 	auto mid2 = (start2 + end2 + 1) / 2;
@@ -52,12 +55,14 @@ bool Filter::isFree(Curve const& curve1, PointID start1, PointID end1, Curve con
 	return comp_dist >= 0 && mid_dist_sqr <= std::pow(comp_dist, 2);
 }
 
-void Filter::increase(size_t& step)
+template <typename T>
+void BasicFilter<T>::increase(size_t& step)
 {
 	step = std::ceil(1.5*step);
 }
 
-void Filter::decrease(size_t& step)
+template <typename T>
+void BasicFilter<T>::decrease(size_t& step)
 {
 	step /= 2;
 }
@@ -66,7 +71,8 @@ void Filter::decrease(size_t& step)
 //NOTE: all calls to cert.XXX() do nothing if CERTIFY is not defined
 //TODO: is it better to use #ifdef CERTIFY blocks here to avoid constructing CPosition objects?
 
-bool Filter::bichromaticFarthestDistance() 
+template <typename T>
+bool BasicFilter<T>::bichromaticFarthestDistance() 
 {
   	cert.reset();
 
@@ -88,17 +94,21 @@ bool Filter::bichromaticFarthestDistance()
 	if (d > distance_sqr) { return false; }
 
 	cert.setAnswer(true);
+	// a traversal visits no position twice, also for single-point curves
 	cert.addPoint( { CPoint(0, 0.), CPoint(0,0.)});
-	if (curve2.size() > 1) {
+	if (curve1.size() > 1 && curve2.size() > 1) {
 		cert.addPoint( { CPoint(curve1.size()-1, 0.), CPoint(0,0.)});
 	}
-	cert.addPoint( { CPoint(curve1.size()-1, 0.), CPoint(curve2.size()-1,0.)});
+	if (curve1.size() > 1 || curve2.size() > 1) {
+		cert.addPoint( { CPoint(curve1.size()-1, 0.), CPoint(curve2.size()-1,0.)});
+	}
 	cert.validate();
 
 	return true;
 }
 
-bool Filter::greedy() 
+template <typename T>
+bool BasicFilter<T>::greedy() 
 {
 	cert.reset();
 	auto& curve1 = *curve1_pt;
@@ -138,7 +148,8 @@ bool Filter::greedy()
 	return true;
 }
 
-bool Filter::adaptiveGreedy(PointID& pos1, PointID& pos2)
+template <typename T>
+bool BasicFilter<T>::adaptiveGreedy(PointID& pos1, PointID& pos2)
 {
 	cert.reset();
 	auto& curve1 = *curve1_pt;
@@ -259,7 +270,8 @@ bool Filter::adaptiveGreedy(PointID& pos1, PointID& pos2)
 	return true;
 }
 
-bool Filter::adaptiveSimultaneousGreedy()
+template <typename T>
+bool BasicFilter<T>::adaptiveSimultaneousGreedy()
 {
 	cert.reset();
 	auto& curve1 = *curve1_pt;
@@ -351,7 +363,8 @@ bool Filter::adaptiveSimultaneousGreedy()
 	return true;
 }
 
-bool Filter::negative(PointID position1, PointID position2)
+template <typename T>
+bool BasicFilter<T>::negative(PointID position1, PointID position2)
 {
 	cert.reset();
 	auto& curve1 = *curve1_pt;
@@ -385,3 +398,72 @@ bool Filter::negative(PointID position1, PointID position2)
 
 	return false;
 }
+
+template <typename T>
+T BasicFilter<T>::upperBound() const
+{
+	auto& curve1 = *curve1_pt;
+	auto& curve2 = *curve2_pt;
+
+	// the same traversal as greedy, but without a distance to stop at
+	auto d_sqr = curve1.back().dist_sqr(curve2.back());
+	PointID pos1 = 0;
+	PointID pos2 = 0;
+
+	while (pos1 + pos2 < curve1.size() + curve2.size() - 2) {
+		d_sqr = std::max(d_sqr, curve1[pos1].dist_sqr(curve2[pos2]));
+
+		if (curve1.size() - 1 == pos1) {
+			++pos2;
+		}
+		else if (curve2.size() - 1 == pos2) {
+			++pos1;
+		}
+		else {
+			distance_t dist1 = curve1[pos1 + 1].dist_sqr(curve2[pos2]);
+			distance_t dist2 = curve1[pos1].dist_sqr(curve2[pos2 + 1]);
+			distance_t dist12 = curve1[pos1 + 1].dist_sqr(curve2[pos2 + 1]);
+
+			if (dist1 < dist2 && dist1 < dist12) {
+				++pos1;
+			} else if (dist2 < dist12) {
+				++pos2;
+			} else {
+				++pos1;
+				++pos2;
+			}
+		}
+	}
+
+	return std::min(std::sqrt(d_sqr), curve1.getUpperBoundDistance(curve2));
+}
+
+template <typename T>
+T BasicFilter<T>::lowerBound() const
+{
+	auto& curve1 = *curve1_pt;
+	auto& curve2 = *curve2_pt;
+
+	auto bound = std::max(curve1.front().dist(curve2.front()), curve1.back().dist(curve2.back()));
+	for (size_t step = 1; step <= curve1.size(); increase(step)) {
+		bound = std::max(bound, distanceToCurve(curve1[step - 1], curve2));
+	}
+	for (size_t step = 1; step <= curve2.size(); increase(step)) {
+		bound = std::max(bound, distanceToCurve(curve2[step - 1], curve1));
+	}
+
+	return bound;
+}
+
+template <typename T>
+T BasicFilter<T>::distanceToCurve(Point const& point, Curve const& curve)
+{
+	auto distance = point.dist(curve.front());
+	for (PointID pt = 0; pt < curve.size()-1; ++pt) {
+		distance = std::min(distance, segmentDistance(point, curve[pt], curve[pt+1]));
+	}
+	return distance;
+}
+
+template class BasicFilter<float>;
+template class BasicFilter<double>;
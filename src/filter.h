@@ -5,15 +5,30 @@
 #include "curves.h"
 #include "certificate.h"
 
-class Filter
+template <typename T>
+class BasicFilter
 {
+public:
+	using distance_t = T;
+	using Point = BasicPoint<T>;
+	using Curve = BasicCurve<T>;
+	using CPoint = BasicCPoint<T>;
+	using Certificate = BasicCertificate<T>;
+
 private:
 	Certificate cert;
-	const Curve *curve1_pt, *curve2_pt;
-	distance_t distance;
+	const Curve *curve1_pt = nullptr, *curve2_pt = nullptr;
+	distance_t distance = 0;
 
 public:
-	Filter(const Curve& curve1, const Curve& curve2, distance_t distance) {
+	BasicFilter() = default;
+	BasicFilter(const Curve& curve1, const Curve& curve2, distance_t distance) {
+		reset(curve1, curve2, distance);
+	}
+
+	// Use the filter for other curves; the memory of the certificate is kept,
+	// see FrechetWorkspace::getFilter.
+	void reset(const Curve& curve1, const Curve& curve2, distance_t distance) {
 		this->curve1_pt = &curve1;
 		this->curve2_pt = &curve2;
 		this->distance = distance;
@@ -31,11 +46,23 @@ public:
 	bool adaptiveSimultaneousGreedy();
 	bool negative(PointID pos1, PointID pos2);
 
+	// Bounds on the Fréchet distance of the two curves which do not depend on
+	// the distance passed to the constructor. The upper bound is the longest
+	// leash on the path of the greedy traversal, the lower bound is the
+	// largest distance of the start points, the end points, or a sample of the
+	// points of one curve to the other curve, like the ones which negative
+	// checks. Both take roughly linear time.
+	distance_t upperBound() const;
+	distance_t lowerBound() const;
+
 	static bool isPointTooFarFromCurve(Point fixed, const Curve& curve, distance_t distance);
 	static bool isFree(Point const& fixed, Curve const& var_curve, PointID start, PointID end,
 	                   distance_t distance);
 	static bool isFree(Curve const& curve1, PointID start1, PointID end1, Curve const& curve2,
 	                   PointID start2, PointID end2, distance_t distance);
+	static distance_t distanceToCurve(Point const& point, Curve const& curve);
 	static void increase(size_t& step);
 	static void decrease(size_t& step);
 };
+
+using Filter = BasicFilter<distance_t>;
@@ -6,14 +6,26 @@
 
 #include <array>
 
-class FrechetAbstract
+template <typename T>
+class BasicFrechetWorkspace;
+
+template <typename T>
+class BasicFrechetAbstract
 {
 public:
-	virtual ~FrechetAbstract() {}
+	using distance_t = T;
+	using Curve = BasicCurve<T>;
+	using Certificate = BasicCertificate<T>;
+	using FrechetWorkspace = BasicFrechetWorkspace<T>;
+
+	virtual ~BasicFrechetAbstract() {}
 	virtual bool lessThan(distance_t distance, Curve const& curve1, Curve const& curve2) = 0;
 	virtual Certificate&  computeCertificate() = 0;
 
 	// yes, this is ugly...
 	virtual void setRules(std::array<bool,5> const& enable) {}
 	virtual void setPruningLevel(int pruning_level) {};
+	virtual void setWorkspace(FrechetWorkspace* workspace) {}
 };
+
+using FrechetAbstract = BasicFrechetAbstract<distance_t>;
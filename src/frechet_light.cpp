@@ -5,8 +5,15 @@
 #include "times.h"
 
 #include <algorithm>
+#include <cmath>
+#include <random>
 
-void FrechetLight::certSetValues(
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+template <typename T>
+void BasicFrechetLight<T>::certSetValues(
 	CInterval& interval, CInterval const& parent, PointID point_id, CurveID curve_id)
 {
 #ifdef CERTIFY
@@ -16,7 +23,8 @@ void FrechetLight::certSetValues(
 #endif
 }
 
-void FrechetLight::certAddEmpty(CPoint begin, CPoint end, CPoint fixed_point, CurveID fixed_curve) {
+template <typename T>
+void BasicFrechetLight<T>::certAddEmpty(CPoint begin, CPoint end, CPoint fixed_point, CurveID fixed_curve) {
 #ifdef CERTIFY
 	assert(begin >= 0);
 	assert(end <= curve_pair[1-fixed_curve]->size() - 1);
@@ -31,7 +39,8 @@ void FrechetLight::certAddEmpty(CPoint begin, CPoint end, CPoint fixed_point, Cu
 #endif
 }
 
-void FrechetLight::certAddNonfreeParts(const CInterval& outer, PointID min, PointID max, PointID fixed_point, CurveID fixed_curve) {
+template <typename T>
+void BasicFrechetLight<T>::certAddNonfreeParts(const CInterval& outer, PointID min, PointID max, PointID fixed_point, CurveID fixed_curve) {
 #ifdef CERTIFY
 	if (outer.is_empty()) {
 		certAddEmpty(CPoint(min,0.), CPoint(max,0.), CPoint(fixed_point,0.), fixed_curve);
@@ -52,7 +61,8 @@ void FrechetLight::certAddNonfreeParts(const CInterval& outer, PointID min, Poin
 #endif
 }
 
-void FrechetLight::visAddReachable(CInterval const& cinterval)
+template <typename T>
+void BasicFrechetLight<T>::visAddReachable(CInterval const& cinterval)
 {
 #ifdef VIS
     if (cinterval.is_empty()) { return; }
@@ -60,7 +70,8 @@ void FrechetLight::visAddReachable(CInterval const& cinterval)
 #endif
 }
 
-void FrechetLight::visAddUnknown(CPoint begin, CPoint end, CPoint fixed_point, CurveID fixed_curve) {
+template <typename T>
+void BasicFrechetLight<T>::visAddUnknown(CPoint begin, CPoint end, CPoint fixed_point, CurveID fixed_curve) {
 #ifdef VIS
 	if (begin >= end) { return; }
 
@@ -76,7 +87,8 @@ void FrechetLight::visAddUnknown(CPoint begin, CPoint end, CPoint fixed_point, C
 #endif
 }
 
-void FrechetLight::visAddConnection(CPoint begin, CPoint end, CPoint fixed_point, CurveID fixed_curve)
+template <typename T>
+void BasicFrechetLight<T>::visAddConnection(CPoint begin, CPoint end, CPoint fixed_point, CurveID fixed_curve)
 {
 #ifdef VIS
 	if (begin >= end) { return; }
@@ -93,7 +105,8 @@ void FrechetLight::visAddConnection(CPoint begin, CPoint end, CPoint fixed_point
 #endif
 }
 
-void FrechetLight::visAddFreeNonReachable(CPoint begin, CPoint end, CPoint fixed_point, CurveID fixed_curve) {
+template <typename T>
+void BasicFrechetLight<T>::visAddFreeNonReachable(CPoint begin, CPoint end, CPoint fixed_point, CurveID fixed_curve) {
 #ifdef VIS
 	if (begin >= end) { return; }
 
@@ -109,12 +122,14 @@ void FrechetLight::visAddFreeNonReachable(CPoint begin, CPoint end, CPoint fixed
 #endif
 }
 
-inline CInterval FrechetLight::getInterval(Point const& point, Curve const& curve, PointID i) const
+template <typename T>
+inline auto BasicFrechetLight<T>::getInterval(Point const& point, Curve const& curve, PointID i) const -> CInterval
 {
 	return getInterval(point, curve, i, nullptr);
 }
 
-inline CInterval FrechetLight::getInterval(Point const& point, Curve const& curve, PointID i, CInterval* outer) const
+template <typename T>
+inline auto BasicFrechetLight<T>::getInterval(Point const& point, Curve const& curve, PointID i, CInterval* outer) const -> CInterval
 {
     Interval outer_temp;
     Interval* outer_pt = outer == nullptr ? nullptr : &outer_temp;
@@ -123,12 +138,13 @@ inline CInterval FrechetLight::getInterval(Point const& point, Curve const& curv
     if (outer != nullptr) {
 		//TODO change intersection_interval so that the outer interval is
 		// 0,1 instead of -eps, 1+eps ?
-		*outer = CInterval{i, std::max(outer_temp.begin,0.), i, std::min(outer_temp.end,1.)};
+		*outer = CInterval{i, std::max<distance_t>(outer_temp.begin,0.), i, std::min<distance_t>(outer_temp.end,1.)};
     }
     return CInterval{i, interval.begin, i, interval.end};
 }
 
-inline void FrechetLight::merge(CIntervals& intervals, CInterval const& new_interval) const
+template <typename T>
+inline void BasicFrechetLight<T>::merge(CIntervals& intervals, CInterval const& new_interval) const
 {
 	if (new_interval.is_empty()) { return; }
 
@@ -140,7 +156,8 @@ inline void FrechetLight::merge(CIntervals& intervals, CInterval const& new_inte
 	}
 }
 
-inline QSimpleInterval FrechetLight::getFreshQSimpleInterval(Point const& fixed_point, PointID min, PointID max, const Curve& curve) const
+template <typename T>
+inline auto BasicFrechetLight<T>::getFreshQSimpleInterval(Point const& fixed_point, PointID min, PointID max, const Curve& curve) const -> QSimpleInterval
 {
 	QSimpleInterval qsimple;
 	updateQSimpleInterval(qsimple, fixed_point, min, max, curve);
@@ -148,7 +165,8 @@ inline QSimpleInterval FrechetLight::getFreshQSimpleInterval(Point const& fixed_
 }
 
 
-inline bool FrechetLight::updateQSimpleInterval(QSimpleInterval& qsimple, Point const& fixed_point, PointID min, PointID max, const Curve& curve) const
+template <typename T>
+inline bool BasicFrechetLight<T>::updateQSimpleInterval(QSimpleInterval& qsimple, Point const& fixed_point, PointID min, PointID max, const Curve& curve) const
 {
 	assert( (qsimple.getFreeInterval().is_empty() and qsimple.getOuterInterval().is_empty()) or (!qsimple.getFreeInterval().is_empty() and !qsimple.getOuterInterval().is_empty()));
 	if (qsimple.is_valid() or (qsimple.hasPartialInformation() and qsimple.getLastValidPoint() >= max)) {
@@ -209,7 +227,8 @@ inline bool FrechetLight::updateQSimpleInterval(QSimpleInterval& qsimple, Point
 }
 
 
-inline void FrechetLight::continueQSimpleSearch(QSimpleInterval& qsimple, Point const& fixed_point, PointID min, PointID max, const Curve& curve) const
+template <typename T>
+inline void BasicFrechetLight<T>::continueQSimpleSearch(QSimpleInterval& qsimple, Point const& fixed_point, PointID min, PointID max, const Curve& curve) const
 {
 	assert(!qsimple.hasPartialInformation() or (qsimple.getLastValidPoint() >= min and qsimple.getLastValidPoint() <= max));
 
@@ -240,6 +259,17 @@ inline void FrechetLight::continueQSimpleSearch(QSimpleInterval& qsimple, Point
 	if (stepsize < 1 or qsimple.hasPartialInformation()) {
 		stepsize = 1;
 	}
+
+	// Free intervals of the next few segments. Most unit steps which need an
+	// intersection interval are isolated, so we only switch to computing them
+	// in batches once a few of them directly followed each other.
+	constexpr std::size_t lookahead = 8;
+	constexpr std::size_t lookahead_min_run = 2;
+	Interval lookahead_intervals[lookahead], lookahead_outers[lookahead];
+	PointID lookahead_begin = 0, lookahead_end = 0;
+	PointID last_intersection = 0;
+	std::size_t intersection_run = 0;
+
 	for (PointID cur = start; cur < max; ) {
 		// heuristic steps:
 		
@@ -290,11 +320,29 @@ inline void FrechetLight::continueQSimpleSearch(QSimpleInterval& qsimple, Point
 		}
 		
 		// otherwise we have to compute the intersection interval:
-		auto const& cur_point = curve[cur];
+		intersection_run = (cur > start && cur == last_intersection + 1) ? intersection_run + 1 : 0;
+		last_intersection = cur;
+
 		Interval outer;
-		auto interval = IntersectionAlgorithm::intersection_interval(fixed_point, distance, cur_point, end_point, &outer);
-		outer.begin = std::max(outer.begin, 0.);
-		outer.end = std::min(outer.end, 1.);
+		Interval interval;
+		if (cur >= lookahead_begin && cur < lookahead_end) {
+			outer = lookahead_outers[cur - lookahead_begin];
+			interval = lookahead_intervals[cur - lookahead_begin];
+		}
+		else if (intersection_run >= lookahead_min_run) {
+			auto size = std::min<std::size_t>(lookahead, max - cur);
+			IntersectionAlgorithm::intersection_intervals(fixed_point, distance, &curve[cur], size, lookahead_intervals, lookahead_outers);
+			lookahead_begin = cur;
+			lookahead_end = cur + size;
+			outer = lookahead_outers[0];
+			interval = lookahead_intervals[0];
+		}
+		else {
+			auto const& cur_point = curve[cur];
+			interval = IntersectionAlgorithm::intersection_interval(fixed_point, distance, cur_point, end_point, &outer);
+		}
+		outer.begin = std::max<distance_t>(outer.begin, 0.);
+		outer.end = std::min<distance_t>(outer.end, 1.);
 		if (interval.is_empty()) {
 			++cur;
 			stepsize *= 2;
@@ -360,7 +408,11 @@ inline void FrechetLight::continueQSimpleSearch(QSimpleInterval& qsimple, Point
 	return;
 }
 
-CIntervals::iterator getIntervalContainingNumber(const CIntervals::iterator& begin, const CIntervals::iterator& end, CPoint const& x) {
+template <typename Iterator>
+Iterator getIntervalContainingNumber(const Iterator& begin, const Iterator& end, typename std::iterator_traits<Iterator>::value_type::CPoint const& x) {
+	using CInterval = typename std::iterator_traits<Iterator>::value_type;
+	using CPoint = typename CInterval::CPoint;
+
 	auto it = std::upper_bound(begin, end, CInterval{x, CPoint{std::numeric_limits<PointID::IDType>::max(),0.}});
 	if (it != begin) {
 		--it;
@@ -371,7 +423,10 @@ CIntervals::iterator getIntervalContainingNumber(const CIntervals::iterator& beg
 	return end;
 }
 
-CIntervals::iterator getIntervalContainingNumber(const CIntervals::iterator& begin, const CIntervals::iterator& end, PointID x) {
+template <typename Iterator>
+Iterator getIntervalContainingNumber(const Iterator& begin, const Iterator& end, PointID x) {
+	using CInterval = typename std::iterator_traits<Iterator>::value_type;
+
 	auto it = std::upper_bound(begin, end, CInterval{x, 0., std::numeric_limits<PointID::IDType>::max(), 0.});
 	if (it != begin) {
 		--it;
@@ -382,48 +437,300 @@ CIntervals::iterator getIntervalContainingNumber(const CIntervals::iterator& beg
 	return end;
 }
 
-void FrechetLight::getReachableIntervals(BoxData& data)
+// Restricts the sorted intervals [begin, end) to the ones which are relevant for
+// the range [min, max], in the same way as splitInTwo distributes the inputs.
+template <typename Iterator>
+void restrictToRange(Iterator& begin, Iterator& end, PointID min, PointID max)
+{
+	using CInterval = typename std::iterator_traits<Iterator>::value_type;
+	auto const max_id = std::numeric_limits<PointID::IDType>::max();
+
+	auto new_end = std::upper_bound(begin, end, CInterval{max, 0., max_id, 0.});
+	auto new_begin = std::upper_bound(begin, new_end, CInterval{min, 0., max_id, 0.});
+	if (new_begin != begin && (new_begin-1)->end >= min) { --new_begin; }
+
+	begin = new_begin;
+	end = new_end;
+}
+
+template <typename T>
+void BasicFrechetLight<T>::getReachableIntervals(BoxData& data)
+{
+	assert(ws->getTaskStack().empty() && ws->getReadyTasks().empty());
+
+	if (traversal_order == TraversalOrder::DepthFirst) {
+		processDepthFirst(data);
+	}
+	else {
+		processByPriority(data);
+	}
+}
+
+// Works like a recursion: the first half of a split box is processed right
+// away, while the second half is pushed onto the stack and only popped once the
+// first half and all of its sub-boxes are processed.
+template <typename T>
+inline void BasicFrechetLight<T>::processDepthFirst(BoxData const& root)
+{
+	auto& stack = ws->getTaskStack();
+
+	BoxData data = root;
+	std::size_t node = 0;
+	if (use_box_nodes && box_nodes.empty()) {
+		box_nodes.emplace_back(root.box);
+	}
+
+	while (true) {
+		bool finished = useKnownOutputs(data, node, stack.size()) || processBox(data);
+		if (early_termination && isTopRightSettled(data.box, root.outputs)) {
+			num_skipped_boxes += !finished;
+			break;
+		}
+		if (!finished) {
+			stack.push_back(splitInTwo(data));
+			if (use_box_nodes) {
+				node = splitNode(node, data.box, stack.back().data.box);
+				box_node_stack.push_back(node + 1);
+			}
+			continue;
+		}
+		closeOutputs(stack.size());
+
+		if (stack.empty()) { break; }
+		auto& task = stack.back();
+		resolvePendingInputs(task);
+		if (early_termination && isStackUnreachable()) { break; }
+		data = task.data;
+		stack.pop_back();
+		if (use_box_nodes) {
+			node = box_node_stack.back();
+			box_node_stack.pop_back();
+		}
+	}
+
+	num_skipped_boxes += stack.size();
+	stack.clear();
+	box_node_stack.clear();
+	open_outputs.clear();
+}
+
+// Sets the outputs of the box which are known from previous distances and
+// returns true if there are no other outputs left. The remaining outputs are
+// recorded, such that closeOutputs can check them once the box is finished.
+template <typename T>
+inline bool BasicFrechetLight<T>::useKnownOutputs(BoxData& data, std::size_t node, std::size_t depth)
+{
+	if (!use_box_nodes) { return false; }
+
+	auto const& box = data.box;
+	assert(box_nodes[node].box == box);
+
+	auto useKnownOutput = [&](CIntervalsID& id, std::size_t side, CInterval const& full) {
+		if (!id.valid()) { return; }
+
+		auto const& box_node = box_nodes[node];
+		auto& intervals = ws->getIntervals(id);
+		if (distance <= box_node.unreachable_up_to[side]) {
+			id.invalidate();
+		}
+		else if (distance >= box_node.reachable_from[side]) {
+			merge(intervals, full);
+			id.invalidate();
+		}
+		else {
+			auto last = intervals.empty() ? CPoint() : intervals.back().end;
+			open_outputs.push_back(OpenOutput{node, side, id, intervals.size(), last, depth});
+		}
+	};
+	useKnownOutput(data.outputs.id1, 0, CInterval{box.min1, 0., box.max1, 0.});
+	useKnownOutput(data.outputs.id2, 1, CInterval{box.min2, 0., box.max2, 0.});
+
+	return !data.outputs.id1.valid() && !data.outputs.id2.valid();
+}
+
+// Stores what is known about the outputs of the boxes which were started at
+// the given depth or deeper, as these boxes are finished.
+template <typename T>
+inline void BasicFrechetLight<T>::closeOutputs(std::size_t depth)
+{
+	while (!open_outputs.empty() && open_outputs.back().depth >= depth) {
+		auto const& output = open_outputs.back();
+		auto const& intervals = ws->getIntervals(output.intervals);
+		auto& box_node = box_nodes[output.node];
+		auto const& box = box_node.box;
+		auto const side = output.side;
+		auto const min = side == 0 ? box.min1 : box.min2;
+		auto const max = side == 0 ? box.max1 : box.max2;
+
+		if (intervals.size() == output.size && (intervals.empty() || intervals.back().end == output.last)) {
+			box_node.unreachable_up_to[side] = std::max(box_node.unreachable_up_to[side], distance);
+		}
+		else if (intervals.back().begin <= CPoint{min, 0.} && intervals.back().end == CPoint{max, 0.}) {
+			box_node.reachable_from[side] = std::min(box_node.reachable_from[side], distance);
+		}
+
+		open_outputs.pop_back();
+	}
+}
+
+// Returns the node of the first sub-box; the node of the second one follows.
+template <typename T>
+inline std::size_t BasicFrechetLight<T>::splitNode(std::size_t node, Box const& first, Box const& second)
+{
+	auto children = box_nodes[node].children;
+	if (children == 0 || !(box_nodes[children].box == first) || !(box_nodes[children+1].box == second)) {
+		children = box_nodes.size();
+		box_nodes[node].children = children;
+		box_nodes.emplace_back(first);
+		box_nodes.emplace_back(second);
+	}
+
+	return children;
+}
+
+// The sub-boxes of a split box become ready once the boxes they take their
+// inputs from are finished. Of all ready boxes, the one with the highest
+// priority according to the traversal order is processed next.
+template <typename T>
+inline void BasicFrechetLight<T>::processByPriority(BoxData const& root)
+{
+	auto& ready_tasks = ws->getReadyTasks();
+
+	// the number of boxes which are not processed yet, i.e., ready or waiting
+	std::size_t open_boxes = 1;
+
+	pushReadyTask(addSubTask(BoxTaskID(), root, CIntervalsID(), CIntervalsID(), 0));
+	while (!ready_tasks.empty()) {
+		BoxTaskID id = popReadyTask();
+		auto& task = ws->getTask(id);
+		resolvePendingInputs(task);
+
+		// copy, as splitting invalidates references to tasks
+		BoxData data = task.data;
+		bool finished = processBox(data);
+		if (early_termination && isTopRightSettled(data.box, root.outputs)) {
+			num_skipped_boxes += open_boxes - finished;
+			ready_tasks.clear();
+			break;
+		}
+
+		if (finished) {
+			finishTask(id);
+			--open_boxes;
+		}
+		else {
+			splitBox(id, data);
+			open_boxes += ws->getTask(id).unfinished_children - 1;
+		}
+	}
+}
+
+// Sets the inputs which were not available when the task was created.
+template <typename T>
+inline void BasicFrechetLight<T>::resolvePendingInputs(BoxTask& task)
+{
+	if (task.pending_input1.valid()) {
+		auto& intervals = ws->getIntervals(task.pending_input1);
+		task.data.inputs.begin1 = intervals.begin();
+		task.data.inputs.end1 = intervals.end();
+	}
+	if (task.pending_input2.valid()) {
+		auto& intervals = ws->getIntervals(task.pending_input2);
+		task.data.inputs.begin2 = intervals.begin();
+		task.data.inputs.end2 = intervals.end();
+	}
+}
+
+// Whether the box contains the top right corner of the free-space diagram and
+// this corner is already known to be reachable. The outputs of such a box are
+// the outputs of the root box.
+template <typename T>
+inline bool BasicFrechetLight<T>::isTopRightSettled(Box const& box, Outputs const& root_outputs) const
+{
+	return box.max1 == curve_pair[0]->size()-1 && box.max2 == curve_pair[1]->size()-1
+		&& isTopRightReachable(root_outputs);
+}
+
+// Pending inputs are only considered as far as they are computed yet.
+template <typename T>
+inline bool BasicFrechetLight<T>::hasReachableInputs(BoxTask const& task) const
+{
+	auto const& inputs = task.data.inputs;
+
+	if (task.pending_input1.valid()) {
+		if (!ws->getIntervals(task.pending_input1).empty()) { return true; }
+	}
+	else if (inputs.haveDownInput() && !inputs.begin1->is_empty()) {
+		return true;
+	}
+	if (task.pending_input2.valid()) {
+		if (!ws->getIntervals(task.pending_input2).empty()) { return true; }
+	}
+	else if (inputs.haveLeftInput() && !inputs.begin2->is_empty()) {
+		return true;
+	}
+
+	return false;
+}
+
+// The boxes on the stack together with the processed boxes form the whole
+// free-space diagram. If none of them has a reachable input, none of them can
+// produce a reachable output, i.e., the remaining inputs stay empty and the
+// answer is settled.
+template <typename T>
+inline bool BasicFrechetLight<T>::isStackUnreachable() const
+{
+	auto const& stack = ws->getTaskStack();
+	for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+		if (hasReachableInputs(*it)) { return false; }
+	}
+	return true;
+}
+
+template <typename T>
+inline bool BasicFrechetLight<T>::processBox(BoxData& data)
 {
 	++num_boxes;
 
 	auto const& box = data.box;
 	auto const& inputs = data.inputs;
-	CInterval const empty;
+	BoxScratch scratch;
 
 	global::times.newSplit();
 
 	assert(box.max1 > box.min1 && box.max2 > box.min2);
-	assert(outputs.id1.valid() || outputs.id2.valid());
+	assert(data.outputs.id1.valid() || data.outputs.id2.valid());
 
-	firstinterval1 = (inputs.begin1 != inputs.end1) ? &*inputs.begin1 : &empty;
-	firstinterval2 = (inputs.begin2 != inputs.end2) ? &*inputs.begin2 : &empty;
+	scratch.firstinterval1 = (inputs.begin1 != inputs.end1) ? &*inputs.begin1 : &empty;
+	scratch.firstinterval2 = (inputs.begin2 != inputs.end2) ? &*inputs.begin2 : &empty;
 
-	if (emptyInputsRule(data)) { return; }
+	if (emptyInputsRule(data, scratch)) { return true; }
 
-	min1_frac = 0., min2_frac = 0.;
-	boxShrinkingRule(data);
+	scratch.min1_frac = 0., scratch.min2_frac = 0.;
+	boxShrinkingRule(data, scratch);
 
 	if (box.isCell()) {
 		visAddCell(box);
-		handleCellCase(data);
-		return;
+		handleCellCase(data, scratch);
+		return true;
 	}
 	else {
-		getQSimpleIntervals(data);
-		calculateQSimple1(data);
-		calculateQSimple2(data);
+		getQSimpleIntervals(data, scratch);
+		calculateQSimple1(data, scratch);
+		calculateQSimple2(data, scratch);
 
-		if (out1_valid && out2_valid) { return; }
-		if (boundaryPruningRule(data)) { return; }
+		if (scratch.out1_valid && scratch.out2_valid) { return true; }
+		if (boundaryPruningRule(data, scratch)) { return true; }
 
 		assert(box.max1 >= box.min1 + 2 || box.max2 >= box.min2 + 2);
 		assert(box.max1 >= box.min1 && box.max2 >= box.min2);
 
-		splitAndRecurse(data);
+		return false;
 	}
 }
 
-inline bool FrechetLight::emptyInputsRule(BoxData& data)
+template <typename T>
+inline bool BasicFrechetLight<T>::emptyInputsRule(BoxData& data, BoxScratch& scratch)
 {
 	auto const& box = data.box;
 
@@ -431,7 +738,7 @@ inline bool FrechetLight::emptyInputsRule(BoxData& data)
 	// Note: if we are currently handling a cell then even if we are not pruning,
 	// we have to return with empty outputs for the subsequent code to work.
 	if (pruning_level > 0 || (box.min1 == box.max1 - 1 && box.min2 == box.max2 - 1)) {
-		if (firstinterval2->is_empty() && firstinterval1->is_empty()) {
+		if (scratch.firstinterval2->is_empty() && scratch.firstinterval1->is_empty()) {
 			if (data.outputs.id2.valid()) {
 				visAddUnknown(CPoint(box.min2,0.), CPoint(box.max2,0.), CPoint(box.max1,0.), 0);
 			}
@@ -445,21 +752,22 @@ inline bool FrechetLight::emptyInputsRule(BoxData& data)
 	return false;
 }
 
-inline void FrechetLight::boxShrinkingRule(BoxData& data)
+template <typename T>
+inline void BasicFrechetLight<T>::boxShrinkingRule(BoxData& data, BoxScratch& scratch)
 {
 	auto& box = data.box;
 
 	// "movement of input boundary" if one of the inputs is empty
 	if (pruning_level > 1 && enable_box_shrinking) {
-		if (firstinterval2->is_empty() && firstinterval1->begin > box.min1) {
+		if (scratch.firstinterval2->is_empty() && scratch.firstinterval1->begin > box.min1) {
 			auto old_min1 = box.min1;
 
-			min1_frac = firstinterval1->begin.getFraction();
-			box.min1 = firstinterval1->begin.getPoint();
+			scratch.min1_frac = scratch.firstinterval1->begin.getFraction();
+			box.min1 = scratch.firstinterval1->begin.getPoint();
 			assert(box.min1 <= box.max1);
 			if (box.min1 == box.max1) {
 				box.min1 = box.max1 - 1;
-				min1_frac = 1.;
+				scratch.min1_frac = 1.;
 			}
 
 			if (box.min1 != old_min1) {
@@ -469,15 +777,15 @@ inline void FrechetLight::boxShrinkingRule(BoxData& data)
 				}
 			}
 		}
-		else if (firstinterval1->is_empty() && firstinterval2->begin > box.min2) {
+		else if (scratch.firstinterval1->is_empty() && scratch.firstinterval2->begin > box.min2) {
 			auto old_min2 = box.min2;
 
-			min2_frac = firstinterval2->begin.getFraction();
-			box.min2 = firstinterval2->begin.getPoint();
+			scratch.min2_frac = scratch.firstinterval2->begin.getFraction();
+			box.min2 = scratch.firstinterval2->begin.getPoint();
 			assert(box.min2 <= box.max2);
 			if (box.min2 == box.max2) {
 				box.min2 = box.max2 - 1;
-				min2_frac = 1.;
+				scratch.min2_frac = 1.;
 			}
 
 			if (box.min2 != old_min2) {
@@ -490,7 +798,8 @@ inline void FrechetLight::boxShrinkingRule(BoxData& data)
 	}
 }
 
-inline void FrechetLight::handleCellCase(BoxData& data)
+template <typename T>
+inline void BasicFrechetLight<T>::handleCellCase(BoxData& data, BoxScratch& scratch)
 {
 	auto const& curve1 = *curve_pair[0];
 	auto const& curve2 = *curve_pair[1];
@@ -501,17 +810,17 @@ inline void FrechetLight::handleCellCase(BoxData& data)
 		//TODO set &outer1 to nullptr if we don't certify? Probably not really costly...
 		CInterval output1 = getInterval(curve2[box.max2], curve1, box.min1, &outer1);
 		certAddNonfreeParts(outer1, box.min1, box.max1, box.max2, 1);
-		if (firstinterval2->is_empty()) {
+		if (scratch.firstinterval2->is_empty()) {
 			visAddFreeNonReachable(
-				output1.begin, std::min(output1.end, firstinterval1->begin), {box.max2,0.}, 1);
+				output1.begin, std::min(output1.end, scratch.firstinterval1->begin), {box.max2,0.}, 1);
 			output1.begin.setFraction(
-				std::max(output1.begin.getFraction(), firstinterval1->begin.getFraction()));
-			certSetValues(output1, *firstinterval1, box.max2, 1);
+				std::max(output1.begin.getFraction(), scratch.firstinterval1->begin.getFraction()));
+			certSetValues(output1, *scratch.firstinterval1, box.max2, 1);
 		}
 		else {
-			certSetValues(output1, *firstinterval2, box.max2, 1);
+			certSetValues(output1, *scratch.firstinterval2, box.max2, 1);
 		}
-		merge(reachable_intervals_vec[data.outputs.id1], output1);
+		merge(ws->getIntervals(data.outputs.id1), output1);
 		visAddReachable(output1);
 	}
 
@@ -519,92 +828,92 @@ inline void FrechetLight::handleCellCase(BoxData& data)
 		CInterval outer2;
 		CInterval output2 = getInterval(curve1[box.max1], curve2, box.min2, &outer2);
 		certAddNonfreeParts(outer2, box.min2, box.max2, box.max1, 0);
-		if (firstinterval1->is_empty()) {
+		if (scratch.firstinterval1->is_empty()) {
 			visAddFreeNonReachable(
-				output2.begin, std::min(output2.end, firstinterval2->begin), {box.max1,0.}, 0);
+				output2.begin, std::min(output2.end, scratch.firstinterval2->begin), {box.max1,0.}, 0);
 			output2.begin.setFraction(
-				std::max(output2.begin.getFraction(), firstinterval2->begin.getFraction()));
-			certSetValues(output2, *firstinterval2, box.max1, 0);
+				std::max(output2.begin.getFraction(), scratch.firstinterval2->begin.getFraction()));
+			certSetValues(output2, *scratch.firstinterval2, box.max1, 0);
 		}
 		else {
-			certSetValues(output2, *firstinterval1, box.max1, 0);
+			certSetValues(output2, *scratch.firstinterval1, box.max1, 0);
 		}
-		merge(reachable_intervals_vec[data.outputs.id2], output2);
+		merge(ws->getIntervals(data.outputs.id2), output2);
 		visAddReachable(output2);
 	}
 }
 
-inline void FrechetLight::getQSimpleIntervals(BoxData& data)
+template <typename T>
+inline void BasicFrechetLight<T>::getQSimpleIntervals(BoxData& data, BoxScratch& scratch)
 {
 	auto const& curve1 = *curve_pair[0];
 	auto const& curve2 = *curve_pair[1];
 	auto const& box = data.box;
 
-	qsimple1.invalidate();
-	qsimple2.invalidate();
+	scratch.qsimple1.invalidate();
+	scratch.qsimple2.invalidate();
 
 	// Get qsimple intervals. Different cases depending on what has been calculated yet.
 	if (data.outputs.id1.valid()) {
 		if (data.qsimple_outputs.id1.valid()) {
-			qsimple1 = qsimple_intervals[data.qsimple_outputs.id1];
+			scratch.qsimple1 = ws->getQSimpleInterval(data.qsimple_outputs.id1);
 		} else {
-			qsimple1 = QSimpleInterval();
+			scratch.qsimple1 = QSimpleInterval();
 		}
-		bool changed = updateQSimpleInterval(qsimple1, curve2[box.max2], box.min1, box.max1, curve1);
+		bool changed = updateQSimpleInterval(scratch.qsimple1, curve2[box.max2], box.min1, box.max1, curve1);
 		if (changed) {
-			qsimple_intervals.push_back(qsimple1);
-			data.qsimple_outputs.id1 = qsimple_intervals.size() - 1;
+			data.qsimple_outputs.id1 = ws->addQSimpleInterval(scratch.qsimple1);
 		}
 	}
 	if (data.outputs.id2.valid()) {
 		if (data.qsimple_outputs.id2.valid()) {
-			qsimple2 = qsimple_intervals[data.qsimple_outputs.id2];
+			scratch.qsimple2 = ws->getQSimpleInterval(data.qsimple_outputs.id2);
 		} else {
-			qsimple2 = QSimpleInterval();
+			scratch.qsimple2 = QSimpleInterval();
 		}
-		bool changed = updateQSimpleInterval(qsimple2, curve1[box.max1], box.min2, box.max2, curve2);
+		bool changed = updateQSimpleInterval(scratch.qsimple2, curve1[box.max1], box.min2, box.max2, curve2);
 		if (changed) {
-			qsimple_intervals.push_back(qsimple2);
-			data.qsimple_outputs.id2 = qsimple_intervals.size()-1;
+			data.qsimple_outputs.id2 = ws->addQSimpleInterval(scratch.qsimple2);
 		}
 	}
 }
 
-inline void FrechetLight::calculateQSimple1(BoxData& data)
+template <typename T>
+inline void BasicFrechetLight<T>::calculateQSimple1(BoxData& data, BoxScratch& scratch)
 {
 	auto const& curve1 = *curve_pair[0];
 	auto const& curve2 = *curve_pair[1];
 	auto const& box = data.box;
 
-	out1_valid = false;
-	out1.make_empty();
+	scratch.out1_valid = false;
+	scratch.out1.make_empty();
 
-	// pruning rules depending on qsimple1
-	if (qsimple1.is_valid()) {
+	// pruning rules depending on scratch.qsimple1
+	if (scratch.qsimple1.is_valid()) {
 		// output boundary is empty
-		if (qsimple1.is_empty()) {
-			// out1 is already empty due to initialization, so leave it.
+		if (scratch.qsimple1.is_empty()) {
+			// scratch.out1 is already empty due to initialization, so leave it.
 			if (pruning_level > 2 && enable_empty_outputs) {
-				out1_valid = true;
+				scratch.out1_valid = true;
 			}
 		}
 		else {
-			CPoint x = (qsimple1.getFreeInterval().begin > CPoint{box.min1,min1_frac}) ? 
-									  qsimple1.getFreeInterval().begin : CPoint{box.min1,min1_frac};
+			CPoint x = (scratch.qsimple1.getFreeInterval().begin > CPoint{box.min1,scratch.min1_frac}) ? 
+									  scratch.qsimple1.getFreeInterval().begin : CPoint{box.min1,scratch.min1_frac};
 			// check if beginning is reachable
 			if (x == box.min1 && pruning_level > 3 && enable_propagation1) {
 				auto it = getIntervalContainingNumber(data.inputs.begin2, data.inputs.end2, box.max2);
 				if (it != data.inputs.end2) { //(box.min1, box.max2) is reachable from interval *it 
 					CInterval &parent = *it; 
-					out1 = qsimple1.getFreeInterval();
-					out1_valid = true;
-					certSetValues(out1, parent, box.max2, 1);
+					scratch.out1 = scratch.qsimple1.getFreeInterval();
+					scratch.out1_valid = true;
+					certSetValues(scratch.out1, parent, box.max2, 1);
 				}
 			}
 			// check if nothing can be reachable
-			if (x != box.min1 && x > qsimple1.getFreeInterval().end && pruning_level > 4 && enable_propagation2) {
-				// out1 is already empty due to initialization, so leave it.
-				out1_valid = true;
+			if (x != box.min1 && x > scratch.qsimple1.getFreeInterval().end && pruning_level > 4 && enable_propagation2) {
+				// scratch.out1 is already empty due to initialization, so leave it.
+				scratch.out1_valid = true;
 			}
 			// check if we can propagate reachability through the box to the beginning
 			// of the free interval
@@ -614,63 +923,64 @@ inline void FrechetLight::calculateQSimple1(BoxData& data)
 					auto interval = getFreshQSimpleInterval(curve1.interpolate_at(x), box.min2, box.max2, curve2);
 					if (interval.is_valid()) {
 						CInterval &parent = *it; 
-						out1 = qsimple1.getFreeInterval();
-						out1.begin = x;
-						out1_valid = true;
-						certSetValues(out1, parent, box.max2, 1);
+						scratch.out1 = scratch.qsimple1.getFreeInterval();
+						scratch.out1.begin = x;
+						scratch.out1_valid = true;
+						certSetValues(scratch.out1, parent, box.max2, 1);
 						visAddConnection({box.min2,0.}, {box.max2,0.}, x, 0);
 					}
 				}
 			}
 		}
 	}
-	if (out1_valid) {
-		merge(reachable_intervals_vec[data.outputs.id1], out1);
-		visAddReachable(out1);
-		certAddNonfreeParts(qsimple1.getOuterInterval(), box.min1, box.max1, box.max2, 1);
-		if (!out1.is_empty()) {
-			visAddFreeNonReachable(qsimple1.getFreeInterval().begin, out1.begin, {box.max2,0.}, 1);
+	if (scratch.out1_valid) {
+		merge(ws->getIntervals(data.outputs.id1), scratch.out1);
+		visAddReachable(scratch.out1);
+		certAddNonfreeParts(scratch.qsimple1.getOuterInterval(), box.min1, box.max1, box.max2, 1);
+		if (!scratch.out1.is_empty()) {
+			visAddFreeNonReachable(scratch.qsimple1.getFreeInterval().begin, scratch.out1.begin, {box.max2,0.}, 1);
 		}
 		data.outputs.id1.invalidate();
 	}
-	out1_valid = !data.outputs.id1.valid();
+	scratch.out1_valid = !data.outputs.id1.valid();
 }
 
-inline void FrechetLight::calculateQSimple2(BoxData& data)
+template <typename T>
+inline void BasicFrechetLight<T>::calculateQSimple2(BoxData& data, BoxScratch& scratch)
 {
 	auto const& curve1 = *curve_pair[0];
 	auto const& curve2 = *curve_pair[1];
 	auto const& box = data.box;
 
-	out2_valid = false;
-	out2.make_empty();
+	scratch.out2_valid = false;
+	scratch.out2.make_empty();
 
-	// pruning rules depending on qsimple2
-	if (qsimple2.is_valid()) {
+	// pruning rules depending on scratch.qsimple2
+	if (scratch.qsimple2.is_valid()) {
 		// output boundary is empty
-		if (qsimple2.is_empty()) {
-			// out2 is already empty due to initialization, so leave it.
+		if (scratch.qsimple2.is_empty()) {
+			// scratch.out2 is already empty due to initialization, so leave it.
 			if (pruning_level > 2 && enable_empty_outputs) {
-				out2_valid = true;
+				scratch.out2_valid = true;
 			}
 		}
 		else {
-			CPoint x = (qsimple2.getFreeInterval().begin > CPoint{box.min2, min2_frac}) ? 
-									  qsimple2.getFreeInterval().begin : CPoint{box.min2, min2_frac};
+			CPoint x = (scratch.qsimple2.getFreeInterval().begin > CPoint{box.min2, scratch.min2_frac}) ? 
+									  scratch.qsimple2.getFreeInterval().begin : CPoint{box.min2, scratch.min2_frac};
 			// check if beginning is reachable
 			if (x == box.min2 && pruning_level > 3 && enable_propagation1) {
 				auto it = getIntervalContainingNumber(data.inputs.begin1, data.inputs.end1, box.max1);
 				if (it != data.inputs.end1) {
 					CInterval &parent = *it; 
-					out2 = qsimple2.getFreeInterval();
-					out2_valid = true;
-					certSetValues(out2, parent, box.max1, 0);
+					scratch.out2 = scratch.qsimple2.getFreeInterval();
+					scratch.out2_valid = true;
+					certSetValues(scratch.out2, parent, box.max1, 0);
 				}
 			}
 			// check if nothing can be reachable
-			if (x != box.min2 && x > qsimple2.getFreeInterval().end && pruning_level > 4 && enable_propagation2) {
-				// out2 is already empty due to initialization, so leave it.
-				out2_valid = true;
+			if (x != box.min2 && x > scratch.qsimple2.getFreeInterval().end && pruning_level > 4 && enable_propagation2) {
+				// scratch.out2 is already empty due to initialization, so leave it.
+				scratch.out2_valid = true;
 			}
 			// check if we can propagate reachability through the box to the beginning
 			// of the free interval
@@ -680,29 +990,30 @@ inline void FrechetLight::calculateQSimple2(BoxData& data)
 					auto interval = getFreshQSimpleInterval(curve2.interpolate_at(x), box.min1, box.max1, curve1);
 					if (interval.is_valid()) {
 						CInterval &parent = *it; 
-						out2 = qsimple2.getFreeInterval();
-						out2.begin = x;
-						out2_valid = true;
-						certSetValues(out2, parent, box.max1,0);
+						scratch.out2 = scratch.qsimple2.getFreeInterval();
+						scratch.out2.begin = x;
+						scratch.out2_valid = true;
+						certSetValues(scratch.out2, parent, box.max1,0);
 						visAddConnection({box.min1,0.}, {box.max1,0.}, x, 1);
 					}
 				}
 			}
 		}
 	}
-	if (out2_valid) {
-		merge(reachable_intervals_vec[data.outputs.id2], out2);
-		visAddReachable(out2);
-		certAddNonfreeParts(qsimple2.getOuterInterval(), box.min2, box.max2, box.max1, 0);
-		if (!out2.is_empty()) {
-			visAddFreeNonReachable(qsimple2.getFreeInterval().begin, out2.begin, {box.max1,0.}, 0);
+	if (scratch.out2_valid) {
+		merge(ws->getIntervals(data.outputs.id2), scratch.out2);
+		visAddReachable(scratch.out2);
+		certAddNonfreeParts(scratch.qsimple2.getOuterInterval(), box.min2, box.max2, box.max1, 0);
+		if (!scratch.out2.is_empty()) {
+			visAddFreeNonReachable(scratch.qsimple2.getFreeInterval().begin, scratch.out2.begin, {box.max1,0.}, 0);
 		}
 		data.outputs.id2.invalidate();
 	}
-	out2_valid = !data.outputs.id2.valid();
+	scratch.out2_valid = !data.outputs.id2.valid();
 }
 
-inline bool FrechetLight::boundaryPruningRule(BoxData& data)
+template <typename T>
+inline bool BasicFrechetLight<T>::boundaryPruningRule(BoxData& data, BoxScratch& scratch)
 {
 	auto const& curve1 = *curve_pair[0];
 	auto const& curve2 = *curve_pair[1];
@@ -710,11 +1021,11 @@ inline bool FrechetLight::boundaryPruningRule(BoxData& data)
 
 	// special cases for boxes which are at the boundary of the freespace diagram
 	if (pruning_level > 5 && enable_boundary_rule) {
-		if (box.max1 == curve1.size()-1 && out1_valid) {
+		if (box.max1 == curve1.size()-1 && scratch.out1_valid) {
 			visAddUnknown({box.min2,0.}, {box.max2,0.}, {box.max1,0.}, 0);
 			return true;
 		}
-		if (box.max2 == curve2.size()-1 && out2_valid) {
+		if (box.max2 == curve2.size()-1 && scratch.out2_valid) {
 			visAddUnknown({box.min1,0.}, {box.max1,0.}, {box.max2,0.}, 1);
 			return true;
 		}
@@ -723,70 +1034,240 @@ inline bool FrechetLight::boundaryPruningRule(BoxData& data)
 	return false;
 }
 
-inline void FrechetLight::splitAndRecurse(BoxData& data)
+template <typename T>
+inline void BasicFrechetLight<T>::splitBox(BoxTaskID id, BoxData const& data)
 {
 	auto const& box = data.box;
 
-	if (box.max2 - box.min2 > box.max1 - box.min1) { // horizontal split
-		reachable_intervals_vec.emplace_back();
-		CIntervalsID inputs1_middleID = reachable_intervals_vec.size()-1;
+	if (box.max1 - box.min1 >= 2 && box.max2 - box.min2 >= 2) {
+		splitInFour(id, data);
+	}
+	else {
+		BoxData first = data;
+		BoxTask second = splitInTwo(first);
+		second.parent = id;
+		second.waiting_for = 1;
+
+		auto second_id = ws->newTask(second);
+		auto first_id = addSubTask(id, first, CIntervalsID(), CIntervalsID(), 0);
+		addDependency(first_id, second_id);
+		ws->getTask(id).unfinished_children = 2;
+		pushReadyTask(first_id);
+	}
+}
 
-		PointID split_position = (box.max2 + box.min2) / 2;
-		assert(split_position > box.min2 && split_position < box.max2);
+// Splits the box into two halves along its longer side. The data is changed to
+// the first half and the second half is returned. As the second half takes the
+// outputs of the first half as inputs, those are only resolved later.
+template <typename T>
+inline auto BasicFrechetLight<T>::splitInTwo(BoxData& data) -> BoxTask
+{
+	auto& box = data.box;
+	auto& inputs = data.inputs;
+	auto const max_id = std::numeric_limits<PointID::IDType>::max();
 
-		auto bound = CInterval{split_position, 0., std::numeric_limits<PointID::IDType>::max(),0.};
-		auto it = std::upper_bound(data.inputs.begin2, data.inputs.end2, bound);
+	BoxTask second{data, CIntervalsID(), CIntervalsID(), BoxTaskID(), 0, {{}}, 0};
 
-		BoxData data_bottom{
-			{box.min1, box.max1, box.min2, split_position},
-			{data.inputs.begin1, data.inputs.end1, data.inputs.begin2, it},
-			{inputs1_middleID, data.outputs.id2},
-			{QSimpleID(), data.qsimple_outputs.id2}
-		};
-		getReachableIntervals(data_bottom);
+	if (box.max2 - box.min2 > box.max1 - box.min1) { // horizontal split
+		CIntervalsID inputs1_middleID = ws->newIntervals();
 
-		if (it != data.inputs.begin2 && (it-1)->end >= split_position) { --it; }
-		CIntervals& inputs1_middle = reachable_intervals_vec[inputs1_middleID];
+		PointID split_position = (box.max2 + box.min2) / 2;
+		assert(split_position > box.min2 && split_position < box.max2);
 
-		BoxData data_top{
-			{box.min1, box.max1, split_position, box.max2},
-			{inputs1_middle.begin(), inputs1_middle.end(), it, data.inputs.end2},
-			{data.outputs.id1, data.outputs.id2},
-			{data.qsimple_outputs.id1, data.qsimple_outputs.id2}
-		};
-		getReachableIntervals(data_top);
+		auto bound = CInterval{split_position, 0., max_id, 0.};
+		auto it = std::upper_bound(inputs.begin2, inputs.end2, bound);
+
+		// top half
+		second.data.box.min2 = split_position;
+		second.data.inputs.begin1 = inputs.end1;
+		second.data.inputs.begin2 = it;
+		if (it != inputs.begin2 && (it-1)->end >= split_position) { --second.data.inputs.begin2; }
+		second.pending_input1 = inputs1_middleID;
+
+		// bottom half
+		box.max2 = split_position;
+		inputs.end2 = it;
+		data.outputs.id1 = inputs1_middleID;
+		data.qsimple_outputs.id1.invalidate();
 	} else { // vertical split
-		reachable_intervals_vec.emplace_back();
-		CIntervalsID inputs2_middleID = reachable_intervals_vec.size()-1;
+		CIntervalsID inputs2_middleID = ws->newIntervals();
 
 		PointID split_position = (box.max1 + box.min1) / 2;
 		assert(split_position > box.min1 && split_position < box.max1);
 
-		auto bound = CInterval{split_position, 0., std::numeric_limits<PointID::IDType>::max(), 0.};
-		auto it = std::upper_bound(data.inputs.begin1, data.inputs.end1, bound);
+		auto bound = CInterval{split_position, 0., max_id, 0.};
+		auto it = std::upper_bound(inputs.begin1, inputs.end1, bound);
+
+		// right half
+		second.data.box.min1 = split_position;
+		second.data.inputs.begin1 = it;
+		if (it != inputs.begin1 && (it-1)->end >= split_position) { --second.data.inputs.begin1; }
+		second.data.inputs.begin2 = inputs.end2;
+		second.pending_input2 = inputs2_middleID;
+
+		// left half
+		box.max1 = split_position;
+		inputs.end1 = it;
+		data.outputs.id2 = inputs2_middleID;
+		data.qsimple_outputs.id2.invalidate();
+	}
 
-		BoxData data_left{
-			{box.min1, split_position, box.min2, box.max2},
-			{data.inputs.begin1, it, data.inputs.begin2, data.inputs.end2},
-			{data.outputs.id1, inputs2_middleID},
-			{data.qsimple_outputs.id1, QSimpleID()}
-		};
-		getReachableIntervals(data_left);
+	return second;
+}
+
+template <typename T>
+inline void BasicFrechetLight<T>::splitInFour(BoxTaskID id, BoxData const& data)
+{
+	auto const& box = data.box;
+	auto const& inputs = data.inputs;
+	auto const max_id = std::numeric_limits<PointID::IDType>::max();
+
+	PointID split1 = (box.max1 + box.min1) / 2;
+	PointID split2 = (box.max2 + box.min2) / 2;
+	assert(split1 > box.min1 && split1 < box.max1);
+	assert(split2 > box.min2 && split2 < box.max2);
+
+	// distribute the inputs like two nested splits of splitInTwo would do
+	auto it1 = std::upper_bound(inputs.begin1, inputs.end1, CInterval{split1, 0., max_id, 0.});
+	auto it2 = std::upper_bound(inputs.begin2, inputs.end2, CInterval{split2, 0., max_id, 0.});
+	auto it1_right = it1;
+	if (it1 != inputs.begin1 && (it1-1)->end >= split1) { --it1_right; }
+	auto it2_top = it2;
+	if (it2 != inputs.begin2 && (it2-1)->end >= split2) { --it2_top; }
+
+	// the interval lists on the four inner boundaries
+	CIntervalsID lower_left_top = ws->newIntervals();
+	CIntervalsID lower_left_right = ws->newIntervals();
+	CIntervalsID lower_right_top = ws->newIntervals();
+	CIntervalsID upper_left_right = ws->newIntervals();
+
+	BoxData data_lower_left{
+		{box.min1, split1, box.min2, split2},
+		{inputs.begin1, it1, inputs.begin2, it2},
+		{lower_left_top, lower_left_right},
+		{QSimpleID(), QSimpleID()}
+	};
+	BoxData data_lower_right{
+		{split1, box.max1, box.min2, split2},
+		{it1_right, inputs.end1, inputs.end2, inputs.end2},
+		{lower_right_top, data.outputs.id2},
+		{QSimpleID(), data.qsimple_outputs.id2}
+	};
+	BoxData data_upper_left{
+		{box.min1, split1, split2, box.max2},
+		{inputs.end1, inputs.end1, it2_top, inputs.end2},
+		{data.outputs.id1, upper_left_right},
+		{data.qsimple_outputs.id1, QSimpleID()}
+	};
+	BoxData data_upper_right{
+		{split1, box.max1, split2, box.max2},
+		{inputs.end1, inputs.end1, inputs.end2, inputs.end2},
+		{data.outputs.id1, data.outputs.id2},
+		{data.qsimple_outputs.id1, data.qsimple_outputs.id2}
+	};
+
+	auto lower_left = addSubTask(id, data_lower_left, CIntervalsID(), CIntervalsID(), 0);
+	auto lower_right = addSubTask(id, data_lower_right, CIntervalsID(), lower_left_right, 1);
+	auto upper_left = addSubTask(id, data_upper_left, lower_left_top, CIntervalsID(), 1);
+	auto upper_right = addSubTask(id, data_upper_right, lower_right_top, upper_left_right, 2);
+	addDependency(lower_left, lower_right);
+	addDependency(lower_left, upper_left);
+	addDependency(lower_right, upper_right);
+	addDependency(upper_left, upper_right);
+	ws->getTask(id).unfinished_children = 4;
+	pushReadyTask(lower_left);
+}
 
-		if (it != data.inputs.begin1 && (it-1)->end >= split_position) { --it; }
-		CIntervals& inputs2_middle = reachable_intervals_vec[inputs2_middleID];
+template <typename T>
+inline BoxTaskID BasicFrechetLight<T>::addSubTask(BoxTaskID parent, BoxData const& data,
+	CIntervalsID pending_input1, CIntervalsID pending_input2, std::size_t waiting_for)
+{
+	return ws->newTask(BoxTask{
+		data, pending_input1, pending_input2,
+		parent, 0, {{BoxTaskID(), BoxTaskID()}}, waiting_for
+	});
+}
 
-		BoxData data_right{
-			{split_position, box.max1, box.min2, box.max2},
-			{it, data.inputs.end1, inputs2_middle.begin(), inputs2_middle.end()},
-			{data.outputs.id1, data.outputs.id2},
-			{data.qsimple_outputs.id1, data.qsimple_outputs.id2}
-		};
-		getReachableIntervals(data_right);
+template <typename T>
+inline void BasicFrechetLight<T>::addDependency(BoxTaskID id, BoxTaskID dependent)
+{
+	auto& dependents = ws->getTask(id).dependents;
+	if (!dependents[0].valid()) {
+		dependents[0] = dependent;
+	}
+	else {
+		assert(!dependents[1].valid());
+		dependents[1] = dependent;
+	}
+}
+
+// Decides which of two ready tasks is processed later.
+template <typename T>
+inline bool BasicFrechetLight<T>::hasLowerPriority(BoxTaskID id1, BoxTaskID id2) const
+{
+	auto const& box1 = ws->getTask(id1).data.box;
+	auto const& box2 = ws->getTask(id2).data.box;
+
+	switch (traversal_order) {
+	case TraversalOrder::LargestFirst:
+		return (std::size_t)(box1.max1 - box1.min1)*(box1.max2 - box1.min2) <
+		       (std::size_t)(box2.max1 - box2.min1)*(box2.max2 - box2.min2);
+	case TraversalOrder::AntiDiagonal:
+		return box1.min1 + box1.min2 > box2.min1 + box2.min2;
+	default:
+		assert(false);
+		return false;
+	}
+}
+
+template <typename T>
+inline void BasicFrechetLight<T>::pushReadyTask(BoxTaskID id)
+{
+	auto& ready_tasks = ws->getReadyTasks();
+	ready_tasks.push_back(id);
+	std::push_heap(ready_tasks.begin(), ready_tasks.end(), [this](BoxTaskID a, BoxTaskID b) {
+		return hasLowerPriority(a, b);
+	});
+}
+
+template <typename T>
+inline BoxTaskID BasicFrechetLight<T>::popReadyTask()
+{
+	auto& ready_tasks = ws->getReadyTasks();
+	std::pop_heap(ready_tasks.begin(), ready_tasks.end(), [this](BoxTaskID a, BoxTaskID b) {
+		return hasLowerPriority(a, b);
+	});
+
+	BoxTaskID id = ready_tasks.back();
+	ready_tasks.pop_back();
+	return id;
+}
+
+// Marks the task as finished, wakes up the tasks waiting for it and finishes
+// the parent if this was its last unfinished child.
+template <typename T>
+inline void BasicFrechetLight<T>::finishTask(BoxTaskID id)
+{
+	while (id.valid()) {
+		auto& task = ws->getTask(id);
+		for (auto dependent: task.dependents) {
+			if (dependent.valid() && --ws->getTask(dependent).waiting_for == 0) {
+				pushReadyTask(dependent);
+			}
+		}
+
+		BoxTaskID parent = task.parent;
+		ws->freeTask(id);
+
+		if (!parent.valid() || --ws->getTask(parent).unfinished_children > 0) {
+			break;
+		}
+		id = parent;
 	}
 }
 
-CPoint FrechetLight::getLastReachablePoint(Point const& point, Curve const& curve) const
+template <typename T>
+auto BasicFrechetLight<T>::getLastReachablePoint(Point const& point, Curve const& curve) const -> CPoint
 {
 	PointID max = curve.size()-1;
 	std::size_t stepsize = 1;
@@ -818,7 +1299,8 @@ CPoint FrechetLight::getLastReachablePoint(Point const& point, Curve const& curv
 	return CPoint{max, 0.};
 }
 
-void FrechetLight::buildFreespaceDiagram(distance_t distance, Curve const& curve1, Curve const& curve2)
+template <typename T>
+void BasicFrechetLight<T>::buildFreespaceDiagram(distance_t distance, Curve const& curve1, Curve const& curve2)
 {
 	this->curve_pair[0] = &curve1;
 	this->curve_pair[1] = &curve2;
@@ -837,12 +1319,15 @@ void FrechetLight::buildFreespaceDiagram(distance_t distance, Curve const& curve
 	computeOutputs(initial_box, initial_inputs, final_outputs);
 }
 
-bool FrechetLight::lessThan(distance_t distance, Curve const& curve1, Curve const& curve2)
+template <typename T>
+bool BasicFrechetLight<T>::lessThan(distance_t distance, Curve const& curve1, Curve const& curve2)
 {
 	this->curve_pair[0] = &curve1;
 	this->curve_pair[1] = &curve2;
 	this->distance = distance;
 	this->dist_sqr = distance * distance;
+	this->num_boxes = 0;
+	this->num_skipped_boxes = 0;
 
 	// curves empty or start or end are already far
 	if (curve1.empty() || curve2.empty()) { return false; }
@@ -868,7 +1353,8 @@ bool FrechetLight::lessThan(distance_t distance, Curve const& curve1, Curve cons
 	return isTopRightReachable(final_outputs);
 }
 
-bool FrechetLight::lessThanWithFilters(distance_t distance, Curve const& curve1, Curve const& curve2)
+template <typename T>
+bool BasicFrechetLight<T>::lessThanWithFilters(distance_t distance, Curve const& curve1, Curve const& curve2)
 {
 	this->curve_pair[0] = &curve1;
 	this->curve_pair[1] = &curve2;
@@ -886,9 +1372,7 @@ bool FrechetLight::lessThanWithFilters(distance_t distance, Curve const& curve1,
 		return true;
 	}
 
-
-	Filter filter(curve1, curve2, distance);
-
+	auto& filter = ws->getFilter(curve1, curve2, distance);
 	if (filter.bichromaticFarthestDistance()) {
 		return true;
 	}
@@ -910,39 +1394,207 @@ bool FrechetLight::lessThanWithFilters(distance_t distance, Curve const& curve1,
 	return lessThan(distance, curve1, curve2);
 }
 
-inline void FrechetLight::computeOutputs(
+template <typename T>
+inline void BasicFrechetLight<T>::computeOutputs(
 	Box const& initial_box, Inputs const& initial_inputs, Outputs& final_outputs)
 {
 	num_boxes = 0;
+	num_skipped_boxes = 0;
+
+#if defined(WITH_OPENMP) && !defined(CERTIFY) && !defined(VIS)
+	if (parallel && curve_pair[0]->size() > 2*parallel_block_size
+	             && curve_pair[1]->size() > 2*parallel_block_size) {
+		computeOutputsParallel(initial_inputs, final_outputs);
+		return;
+	}
+#endif
 
 	BoxData box_data{initial_box, initial_inputs, final_outputs, QSimpleOutputs()};
 	getReachableIntervals(box_data);
 }
 
-inline void FrechetLight::visAddCell(Box const& box)
+template <typename T>
+void BasicFrechetLight<T>::computeOutputsParallel(Inputs const& initial_inputs, Outputs& final_outputs)
+{
+#ifdef WITH_OPENMP
+	auto getBoundaries = [this](std::size_t size) {
+		auto num_blocks = std::max<std::size_t>(size/parallel_block_size, 1);
+		std::vector<PointID> boundaries(num_blocks + 1);
+		for (std::size_t i = 0; i <= num_blocks; ++i) {
+			boundaries[i] = i*size/num_blocks;
+		}
+		return boundaries;
+	};
+	auto const boundaries1 = getBoundaries(curve_pair[0]->size()-1);
+	auto const boundaries2 = getBoundaries(curve_pair[1]->size()-1);
+	auto const num_blocks1 = boundaries1.size()-1;
+	auto const num_blocks2 = boundaries2.size()-1;
+
+	// Every thread works with its own decider and thus its own workspace.
+	std::size_t num_threads = omp_get_max_threads();
+	while (workers.size() < num_threads) {
+		workers.emplace_back(new BasicFrechetLight());
+	}
+	for (auto& worker: workers) {
+		prepareWorker(*worker);
+	}
+
+	// The output intervals of a block live in the workspace of the worker
+	// which processed this block.
+	struct Block {
+		std::size_t worker;
+		Outputs outputs;
+	};
+	std::vector<Block> blocks(num_blocks1*num_blocks2);
+	auto getBlock = [&](std::size_t i, std::size_t j) -> Block& {
+		return blocks[i*num_blocks2 + j];
+	};
+	auto getOutputIntervals = [&](Block const& block, CIntervalsID id) -> CIntervals& {
+		return workers[block.worker]->ws->getIntervals(id);
+	};
+
+	std::vector<Inputs> diagonal_inputs;
+	std::size_t num_processed_blocks = 0;
+	bool unreachable = false;
+	for (std::size_t d = 0; d < num_blocks1 + num_blocks2 - 1; ++d) {
+		// the blocks (i, d-i) for i_min <= i <= i_max are on this anti-diagonal
+		std::size_t i_min = d < num_blocks2 ? 0 : d - num_blocks2 + 1;
+		std::size_t i_max = std::min(d, num_blocks1 - 1);
+
+		// The inputs are collected before the parallel part, as the workspaces
+		// must not be accessed while their owners are adding new lists.
+		diagonal_inputs.clear();
+		for (std::size_t i = i_min; i <= i_max; ++i) {
+			std::size_t j = d - i;
+			Inputs inputs = initial_inputs;
+
+			if (j == 0) {
+				restrictToRange(inputs.begin1, inputs.end1, boundaries1[i], boundaries1[i+1]);
+			}
+			else {
+				auto& intervals = getOutputIntervals(getBlock(i, j-1), getBlock(i, j-1).outputs.id1);
+				inputs.begin1 = intervals.begin();
+				inputs.end1 = intervals.end();
+			}
+			if (i == 0) {
+				restrictToRange(inputs.begin2, inputs.end2, boundaries2[j], boundaries2[j+1]);
+			}
+			else {
+				auto& intervals = getOutputIntervals(getBlock(i-1, j), getBlock(i-1, j).outputs.id2);
+				inputs.begin2 = intervals.begin();
+				inputs.end2 = intervals.end();
+			}
+
+			diagonal_inputs.push_back(inputs);
+		}
+
+		// If nothing is reachable on this anti-diagonal, then nothing is on the
+		// following ones, as the initial inputs are prefixes of the boundaries.
+		auto hasReachableInput = [](Inputs const& inputs) {
+			return (inputs.haveDownInput() && !inputs.begin1->is_empty())
+			    || (inputs.haveLeftInput() && !inputs.begin2->is_empty());
+		};
+		if (early_termination && std::none_of(diagonal_inputs.begin(), diagonal_inputs.end(), hasReachableInput)) {
+			num_skipped_boxes += blocks.size() - num_processed_blocks;
+			unreachable = true;
+			break;
+		}
+
+		#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads)
+		for (std::size_t k = 0; k < diagonal_inputs.size(); ++k) {
+			std::size_t i = i_min + k;
+			std::size_t j = d - i;
+			std::size_t worker_index = omp_get_thread_num();
+			auto& worker = *workers[worker_index];
+
+			auto& block = getBlock(i, j);
+			block.worker = worker_index;
+			block.outputs.id1 = worker.ws->newIntervals();
+			block.outputs.id2 = worker.ws->newIntervals();
+
+			BoxData box_data{
+				{boundaries1[i], boundaries1[i+1], boundaries2[j], boundaries2[j+1]},
+				diagonal_inputs[k],
+				block.outputs,
+				QSimpleOutputs()
+			};
+			worker.getReachableIntervals(box_data);
+		}
+		num_processed_blocks += diagonal_inputs.size();
+	}
+
+	// The top and right blocks together form the final outputs.
+	if (!unreachable) {
+		for (std::size_t i = 0; i < num_blocks1; ++i) {
+			auto const& block = getBlock(i, num_blocks2-1);
+			for (auto const& interval: getOutputIntervals(block, block.outputs.id1)) {
+				merge(ws->getIntervals(final_outputs.id1), interval);
+			}
+		}
+		for (std::size_t j = 0; j < num_blocks2; ++j) {
+			auto const& block = getBlock(num_blocks1-1, j);
+			for (auto const& interval: getOutputIntervals(block, block.outputs.id2)) {
+				merge(ws->getIntervals(final_outputs.id2), interval);
+			}
+		}
+	}
+
+	for (auto const& worker: workers) {
+		num_boxes += worker->num_boxes;
+		num_skipped_boxes += worker->num_skipped_boxes;
+	}
+#endif
+}
+
+template <typename T>
+void BasicFrechetLight<T>::prepareWorker(BasicFrechetLight& worker) const
+{
+	worker.curve_pair = curve_pair;
+	worker.distance = distance;
+	worker.dist_sqr = dist_sqr;
+	worker.num_boxes = 0;
+	worker.num_skipped_boxes = 0;
+
+	worker.pruning_level = pruning_level;
+	worker.enable_box_shrinking = enable_box_shrinking;
+	worker.enable_empty_outputs = enable_empty_outputs;
+	worker.enable_propagation1 = enable_propagation1;
+	worker.enable_propagation2 = enable_propagation2;
+	worker.enable_boundary_rule = enable_boundary_rule;
+	worker.traversal_order = traversal_order;
+	worker.early_termination = early_termination;
+
+	worker.clear();
+}
+
+template <typename T>
+inline void BasicFrechetLight<T>::visAddCell(Box const& box)
 {
 #ifdef VIS
 	cells.emplace_back(box.min1, box.min2);
 #endif
 }
 
-inline bool FrechetLight::isClose(Point const& point, Curve const& curve) const
+template <typename T>
+inline bool BasicFrechetLight<T>::isClose(Point const& point, Curve const& curve) const
 {
 	return getLastReachablePoint(point, curve) == CPoint{PointID(curve.size()-1), 0.};
 }
 
-inline bool FrechetLight::isTopRightReachable(Outputs const& outputs) const
+template <typename T>
+inline bool BasicFrechetLight<T>::isTopRightReachable(Outputs const& outputs) const
 {
 	auto const& curve1 = *curve_pair[0];
 	auto const& curve2 = *curve_pair[1];
-	auto const& outputs1 = reachable_intervals_vec[outputs.id1];
-	auto const& outputs2 = reachable_intervals_vec[outputs.id2];
+	auto const& outputs1 = ws->getIntervals(outputs.id1);
+	auto const& outputs2 = ws->getIntervals(outputs.id2);
 
 	return (!outputs1.empty() && (outputs1.back().end.getPoint() == curve1.size()-1))
 		|| (!outputs2.empty() && (outputs2.back().end.getPoint() == curve2.size()-1));
 }
 
-inline void FrechetLight::initCertificate(Inputs const& initial_inputs)
+template <typename T>
+inline void BasicFrechetLight<T>::initCertificate(Inputs const& initial_inputs)
 {
 #ifdef CERTIFY
 	auto const& curve1 = *curve_pair[0];
@@ -962,20 +1614,20 @@ inline void FrechetLight::initCertificate(Inputs const& initial_inputs)
 #endif
 }
 
-inline auto FrechetLight::createFinalOutputs() -> Outputs
+template <typename T>
+inline auto BasicFrechetLight<T>::createFinalOutputs() -> Outputs
 {
 	Outputs outputs;
 
-	reachable_intervals_vec.emplace_back();
-	outputs.id1 = reachable_intervals_vec.size()-1;
-	reachable_intervals_vec.emplace_back();
-	outputs.id2 = reachable_intervals_vec.size()-1;
+	outputs.id1 = ws->newIntervals();
+	outputs.id2 = ws->newIntervals();
 
 	return outputs;
 }
 
 // this function assumes that the start points of the two curves are close
-inline auto FrechetLight::computeInitialInputs() -> Inputs
+template <typename T>
+inline auto BasicFrechetLight<T>::computeInitialInputs() -> Inputs
 {
 	Inputs inputs;
 
@@ -985,29 +1637,49 @@ inline auto FrechetLight::computeInitialInputs() -> Inputs
 	auto const first = CPoint(0,0.);
 
 	auto last1 = getLastReachablePoint(curve2.front(), curve1);
-	reachable_intervals_vec.emplace_back();
-	reachable_intervals_vec.back().emplace_back(first, last1);
-	inputs.begin1 = reachable_intervals_vec.back().begin();
-	inputs.end1 = reachable_intervals_vec.back().end();
+	auto& inputs1 = ws->getIntervals(ws->newIntervals());
+	inputs1.emplace_back(first, last1);
+	inputs.begin1 = inputs1.begin();
+	inputs.end1 = inputs1.end();
 
 	auto last2 = getLastReachablePoint(curve1.front(), curve2);
-	reachable_intervals_vec.emplace_back();
-	reachable_intervals_vec.back().emplace_back(first, last2);
-	inputs.begin2 = reachable_intervals_vec.back().begin();
-	inputs.end2 = reachable_intervals_vec.back().end();
+	auto& inputs2 = ws->getIntervals(ws->newIntervals());
+	inputs2.emplace_back(first, last2);
+	inputs.begin2 = inputs2.begin();
+	inputs.end2 = inputs2.end();
 
 	return inputs;
 }
 
-distance_t FrechetLight::calcDistance(Curve const& curve1, Curve const& curve2)
+template <typename T>
+T BasicFrechetLight<T>::calcDistance(Curve const& curve1, Curve const& curve2, distance_t max_distance)
 {
-	static constexpr distance_t epsilon = 1e-10;
+	// the cheap bounds are usually much tighter than [0, bounding box diagonal]
+	auto const& filter = ws->getFilter(curve1, curve2, 0.);
+	distance_t min = filter.lowerBound();
+	distance_t max = filter.upperBound();
+
+	auto const too_far = std::numeric_limits<distance_t>::infinity();
+	if (min > max_distance) { return too_far; }
+	if (max > max_distance) {
+		if (!lessThanWithFilters(max_distance, curve1, curve2)) { return too_far; }
+		max = max_distance;
+	}
 
-	distance_t min = 0.;
-	distance_t max = curve1.getUpperBoundDistance(curve2);
+	box_nodes.clear();
+#ifndef CERTIFY
+	// the certificate needs the empty intervals of all boxes
+	use_box_nodes = true;
+#endif
 
-	while (max - min >= epsilon) {
-		auto split = (max + min)/2.;
+	if (search_width > 1) {
+		searchParallel(min, max, curve1, curve2);
+	}
+
+	while (max - min >= eps) {
+		distance_t split = (max + min)/2.;
+		// for large distances, the precision of distance_t can be worse than eps
+		if (split <= min || split >= max) { break; }
 		if (lessThanWithFilters(split, curve1, curve2)) {
 			max = split;
 		}
@@ -1016,15 +1688,307 @@ distance_t FrechetLight::calcDistance(Curve const& curve1, Curve const& curve2)
 		}
 	}
 
+	use_box_nodes = false;
+
 	return (max + min)/2.;
 }
 
+template <typename T>
+void BasicFrechetLight<T>::searchParallel(distance_t& min, distance_t& max, Curve const& curve1, Curve const& curve2)
+{
+#ifdef WITH_OPENMP
+	// Every candidate distance of a round has its own worker. As worker i
+	// always gets the i-th candidate, the answers and thus the result do not
+	// depend on the scheduling of the threads.
+	std::size_t const num_candidates = search_width;
+	while (workers.size() < num_candidates) {
+		workers.emplace_back(new BasicFrechetLight());
+	}
+	for (std::size_t i = 0; i < num_candidates; ++i) {
+		auto& worker = *workers[i];
+		prepareWorker(worker);
+		worker.non_filtered = 0;
+		worker.box_nodes.clear();
+		worker.use_box_nodes = use_box_nodes;
+	}
+
+	std::vector<distance_t> splits(num_candidates);
+	std::vector<char> answers(num_candidates);
+	while (max - min >= eps) {
+		for (std::size_t i = 0; i < num_candidates; ++i) {
+			splits[i] = min + (max - min)*(i + 1)/(num_candidates + 1);
+		}
+		// for large distances, the precision of distance_t can be worse than eps
+		if (splits.front() <= min || splits.back() >= max) { break; }
+
+		#pragma omp parallel for schedule(static, 1) num_threads(num_candidates)
+		for (std::size_t i = 0; i < num_candidates; ++i) {
+			answers[i] = workers[i]->lessThanWithFilters(splits[i], curve1, curve2);
+		}
+
+		// the decider is monotone, so the first true answer is the new upper bound
+		std::size_t first = std::find(answers.begin(), answers.end(), true) - answers.begin();
+		if (first < num_candidates) { max = splits[first]; }
+		if (first > 0) { min = splits[first-1]; }
+	}
+
+	for (std::size_t i = 0; i < num_candidates; ++i) {
+		non_filtered += workers[i]->non_filtered;
+		workers[i]->use_box_nodes = false;
+	}
+#else
+	(void) min; (void) max; (void) curve1; (void) curve2;
+#endif
+}
+
+template <typename T>
+auto BasicFrechetLight<T>::calcDistanceApprox(Curve const& curve1, Curve const& curve2, distance_t rel_eps) -> Interval
+{
+	// the decider below reuses the filter of the workspace
+	auto const& filter = ws->getFilter(curve1, curve2, 0.);
+	distance_t min = filter.lowerBound();
+	distance_t const upper_bound = filter.upperBound();
+	if (lessThanWithFilters(min, curve1, curve2)) { return {min, min}; }
+
+	box_nodes.clear();
+#ifndef CERTIFY
+	use_box_nodes = true;
+#endif
+
+	// Find a tighter upper bound by doubling the lower bound, such that the
+	// bracket only depends on the ratio of the bounds and not on the coordinates.
+	distance_t max = upper_bound;
+	for (distance_t split = 2*min; min > 0 && split < upper_bound; split *= 2) {
+		if (lessThanWithFilters(split, curve1, curve2)) {
+			max = split;
+			break;
+		}
+		min = split;
+	}
+
+	// Bisect geometrically, i.e., halve the ratio of the bounds in log scale.
+	// The absolute eps only ends the search if the distance is (almost) zero.
+	while (max > min*(1 + rel_eps) && max - min >= eps) {
+		distance_t split = (min > 0 ? std::sqrt(min*max) : max/2);
+		if (split <= min || split >= max) { break; }
+		if (lessThanWithFilters(split, curve1, curve2)) {
+			max = split;
+		}
+		else {
+			min = split;
+		}
+	}
+
+	use_box_nodes = false;
+
+	return {min, max};
+}
+
+namespace
+{
+
+// Keeps the values in (lo, hi) which are added. If there are more than
+// capacity many, a uniform sample of them is kept.
+template <typename T>
+class CriticalValues
+{
+public:
+	CriticalValues(T lo, T hi, std::size_t capacity)
+		: lo(lo), hi(hi), capacity(capacity), gen(capacity) {}
+
+	T getLowerBound() const { return lo; }
+	T getUpperBound() const { return hi; }
+
+	void add(T value)
+	{
+		if (value <= lo || value >= hi) { return; }
+
+		++num_added;
+		if (values.size() < capacity) {
+			values.push_back(value);
+		}
+		else {
+			auto index = std::uniform_int_distribution<std::size_t>(0, num_added-1)(gen);
+			if (index < capacity) { values[index] = value; }
+		}
+	}
+
+	std::vector<T>& getValues() { return values; }
+	bool isComplete() const { return num_added == values.size(); }
+
+private:
+	T lo, hi;
+	std::size_t capacity;
+	std::size_t num_added = 0;
+	std::vector<T> values;
+	std::mt19937 gen;
+};
+
+// Narrows down (lo, hi] to two consecutive values of the ones which are
+// produced by enumerate, where the decider is false for lo and true for hi.
+template <typename T, typename Decide, typename Enumerate>
+void searchCriticalValues(T& lo, T& hi, Decide decide, Enumerate enumerate)
+{
+	// the number of values which are searched at once; if there are more, the
+	// search is repeated in the smaller bracket which the sample gives
+	constexpr std::size_t capacity = 4096;
+
+	while (true) {
+		CriticalValues<T> critical_values(lo, hi, capacity);
+		enumerate(critical_values);
+
+		auto& values = critical_values.getValues();
+		if (values.empty()) { return; }
+		std::sort(values.begin(), values.end());
+		values.erase(std::unique(values.begin(), values.end()), values.end());
+
+		// find the first value for which the decider is true
+		std::size_t first = 0, last = values.size();
+		while (first < last) {
+			auto mid = (first + last)/2;
+			if (decide(values[mid])) {
+				last = mid;
+			}
+			else {
+				first = mid + 1;
+			}
+		}
+		if (first < values.size()) { hi = values[first]; }
+		if (first > 0) { lo = values[first-1]; }
+
+		if (critical_values.isComplete()) { return; }
+	}
+}
+
+// The distances at which a passage opens between a point of curve1 and a
+// segment of curve2.
+template <typename T>
+void addVertexSegmentValues(BasicCurve<T> const& curve1, BasicCurve<T> const& curve2, CriticalValues<T>& values)
+{
+	auto const last = curve2.size() - 1;
+	for (auto const& point: curve1) {
+		for (std::size_t j = 0; j < std::max<std::size_t>(last, 1); ++j) {
+			values.add(segmentDistance(point, curve2[j], curve2[std::min(j+1, last)]));
+		}
+	}
+}
+
+// The distances at which a horizontal or vertical passage in the free-space
+// diagram opens, i.e., at which the first free point of a point of curve1 on
+// a segment of curve2 coincides with the last free point of a later point of
+// curve1 on the same segment. Only the pairs of points are considered whose
+// first resp. last free point can lie in the bracket of the values; these are
+// found by a sweep over the ranges in which these free points can lie.
+template <typename T>
+void addMonotonicityValues(BasicCurve<T> const& curve1, BasicCurve<T> const& curve2, CriticalValues<T>& values)
+{
+	struct Range
+	{
+		T begin;
+		T end;
+		std::size_t point;
+		bool first_free;
+
+		bool operator<(Range const& other) const { return begin < other.begin; }
+	};
+	std::vector<Range> ranges;
+	std::vector<Range const*> active_first, active_last;
+
+	auto const lo = values.getLowerBound();
+	auto const hi = values.getUpperBound();
+	auto const margin = 4*std::numeric_limits<T>::epsilon();
+
+	for (std::size_t j = 0; j + 1 < curve2.size(); ++j) {
+		auto const direction = curve2[j+1] - curve2[j];
+		auto const length_sqr = direction.x*direction.x + direction.y*direction.y;
+		if (length_sqr == 0) { continue; }
+
+		// the free points of a point at distance r lie at t -/+ sqrt(r^2 - h^2)
+		ranges.clear();
+		for (std::size_t i = 0; i < curve1.size(); ++i) {
+			auto const diff = curve1[i] - curve2[j];
+			auto const projection = diff.x*direction.x + diff.y*direction.y;
+			auto const t = projection/length_sqr;
+			auto const h_sqr = std::max<T>(0, diff.x*diff.x + diff.y*diff.y - projection*t);
+			if (h_sqr >= hi*hi) { continue; }
+
+			auto const lo_offset = std::sqrt(std::max<T>(0, lo*lo - h_sqr)/length_sqr);
+			auto const hi_offset = std::sqrt((hi*hi - h_sqr)/length_sqr);
+			auto const add_range = [&](T begin, T end, bool first_free) {
+				begin = std::max<T>(0, begin - margin);
+				end = std::min<T>(1, end + margin);
+				if (begin <= end) { ranges.push_back({begin, end, i, first_free}); }
+			};
+			add_range(t - hi_offset, t - lo_offset, true);
+			add_range(t + lo_offset, t + hi_offset, false);
+		}
+		std::sort(ranges.begin(), ranges.end());
+
+		// a range overlaps exactly the active ranges which end after its begin
+		active_first.clear();
+		active_last.clear();
+		auto overlapping = [](std::vector<Range const*>& active, T begin) -> std::vector<Range const*>& {
+			active.erase(std::remove_if(active.begin(), active.end(),
+				[&](Range const* range) { return range->end < begin; }), active.end());
+			return active;
+		};
+		for (auto const& range: ranges) {
+			auto& others = overlapping(range.first_free ? active_last : active_first, range.begin);
+			for (auto const* other: others) {
+				auto const first = range.first_free ? range.point : other->point;
+				auto const last = range.first_free ? other->point : range.point;
+				T distance;
+				if (first < last && bisectorDistance(curve1[first], curve1[last], curve2[j], curve2[j+1], distance)) {
+					values.add(distance);
+				}
+			}
+			overlapping(range.first_free ? active_first : active_last, range.begin).push_back(&range);
+		}
+	}
+}
+
+} // end anonymous namespace
+
+template <typename T>
+T BasicFrechetLight<T>::calcDistanceExact(Curve const& curve1, Curve const& curve2)
+{
+	// The tested distances are increased slightly, as the decider can miss a
+	// passage which consists of a single point.
+	auto decide = [&](distance_t distance) {
+		return lessThanWithFilters(distance*(1 + critical_slack), curve1, curve2);
+	};
+
+	// the smallest critical value is the distance of the start or end points
+	distance_t min = std::max(curve1.front().dist(curve2.front()), curve1.back().dist(curve2.back()));
+	if (decide(min)) { return min; }
+	distance_t max = ws->getFilter(curve1, curve2, 0.).upperBound();
+
+	box_nodes.clear();
+#ifndef CERTIFY
+	use_box_nodes = true;
+#endif
+
+	searchCriticalValues(min, max, decide, [&](CriticalValues<T>& values) {
+		addVertexSegmentValues(curve1, curve2, values);
+		addVertexSegmentValues(curve2, curve1, values);
+	});
+	searchCriticalValues(min, max, decide, [&](CriticalValues<T>& values) {
+		addMonotonicityValues(curve1, curve2, values);
+		addMonotonicityValues(curve2, curve1, values);
+	});
+
+	use_box_nodes = false;
+
+	// the decider is true for max and false for all smaller critical values
+	return max;
+}
+
 // This doesn't have to be called but is handy to make time measurements more consistent
 // such that the clears in the lessThan call doen't have to do anything.
-void FrechetLight::clear()
+template <typename T>
+void BasicFrechetLight<T>::clear()
 {
-	reachable_intervals_vec.clear();
-	qsimple_intervals.clear();
+	ws->reset();
 
 #ifdef VIS
 	unknown_intervals.clear();
@@ -1035,16 +1999,19 @@ void FrechetLight::clear()
 #endif
 }
 
-bool FrechetLight::isOnLowerRight(const CPosition& pt) const
+template <typename T>
+bool BasicFrechetLight<T>::isOnLowerRight(const CPosition& pt) const
 {
 	return pt[0] == curve_pair[0]->size()-1 or pt[1] == 0;
 }
-bool FrechetLight::isOnUpperLeft(const CPosition& pt) const
+template <typename T>
+bool BasicFrechetLight<T>::isOnUpperLeft(const CPosition& pt) const
 {
 	return pt[0] == 0 or pt[1] == curve_pair[1]->size()-1;
 }
 
-Certificate& FrechetLight::computeCertificate() {
+template <typename T>
+auto BasicFrechetLight<T>::computeCertificate() -> Certificate& {
 #ifndef CERTIFY
 	return cert;
 #else
@@ -1122,8 +2089,8 @@ Certificate& FrechetLight::computeCertificate() {
 
 
 
-	CIntervals const& outputs1 = reachable_intervals_vec[2];
-	CIntervals const& outputs2 = reachable_intervals_vec[3];
+	CIntervals const& outputs1 = ws->getIntervals(2);
+	CIntervals const& outputs2 = ws->getIntervals(3);
 
 	bool answer = false;
 	CInterval const* last_interval;
@@ -1215,7 +2182,7 @@ Certificate& FrechetLight::computeCertificate() {
 				} else {
 					query_bottomright[1] = CPoint(0, 0.);
 				}
-				RangeSearch::Point query = {next_point[0], next_point[1]};
+				typename RangeSearch::Point query = {next_point[0], next_point[1]};
 				intervals_remaining.searchAndDelete(query, stack);
 
 				for (auto new_id = first_new; new_id < stack.size(); ++new_id) {
@@ -1273,17 +2240,20 @@ Certificate& FrechetLight::computeCertificate() {
 #endif
 }
 
-auto FrechetLight::getCurvePair() const -> CurvePair
+template <typename T>
+auto BasicFrechetLight<T>::getCurvePair() const -> CurvePair
 {
 	return curve_pair;
 }
 
-void FrechetLight::setPruningLevel(int pruning_level)
+template <typename T>
+void BasicFrechetLight<T>::setPruningLevel(int pruning_level)
 {
 	this->pruning_level = pruning_level;
 }
 
-void FrechetLight::setRules(std::array<bool,5> const& enable)
+template <typename T>
+void BasicFrechetLight<T>::setRules(std::array<bool,5> const& enable)
 {
 	enable_box_shrinking = enable[0];
 	enable_empty_outputs = enable[1];
@@ -1292,7 +2262,55 @@ void FrechetLight::setRules(std::array<bool,5> const& enable)
 	enable_boundary_rule = enable[4];
 }
 
-std::size_t FrechetLight::getNumberOfBoxes() const
+template <typename T>
+void BasicFrechetLight<T>::setWorkspace(FrechetWorkspace* workspace)
+{
+	ws = workspace != nullptr ? workspace : &own_workspace;
+}
+
+template <typename T>
+void BasicFrechetLight<T>::setParallel(bool parallel)
+{
+	this->parallel = parallel;
+}
+
+template <typename T>
+void BasicFrechetLight<T>::setParallelBlockSize(std::size_t block_size)
+{
+	assert(block_size >= 1);
+	parallel_block_size = block_size;
+}
+
+template <typename T>
+void BasicFrechetLight<T>::setParallelSearch(std::size_t num_candidates)
+{
+	assert(num_candidates >= 1);
+	search_width = num_candidates;
+}
+
+template <typename T>
+void BasicFrechetLight<T>::setTraversalOrder(TraversalOrder order)
+{
+	traversal_order = order;
+}
+
+template <typename T>
+void BasicFrechetLight<T>::setEarlyTermination(bool early_termination)
+{
+	this->early_termination = early_termination;
+}
+
+template <typename T>
+std::size_t BasicFrechetLight<T>::getNumberOfBoxes() const
 {
 	return num_boxes;
 }
+
+template <typename T>
+std::size_t BasicFrechetLight<T>::getNumberOfSkippedBoxes() const
+{
+	return num_skipped_boxes;
+}
+
+template class BasicFrechetLight<float>;
+template class BasicFrechetLight<double>;
@@ -4,6 +4,7 @@
 #include "filter.h"
 #include "frechet_abstract.h"
 #include "frechet_light_types.h"
+#include "frechet_workspace.h"
 #include "geometry_basics.h"
 #include "id.h"
 #include "certificate.h"
@@ -13,22 +14,71 @@
 #endif
 
 #include <array>
+#include <limits>
+#include <memory>
 #include <vector>
 
-class FrechetLight final : public FrechetAbstract
+template <typename T>
+class BasicFrechetLight final : public BasicFrechetAbstract<T>
 {
+public:
+	using distance_t = T;
+	using Point = BasicPoint<T>;
+	using Curve = BasicCurve<T>;
+	using Certificate = BasicCertificate<T>;
+	using FrechetWorkspace = BasicFrechetWorkspace<T>;
+	using Interval = BasicInterval<T>;
+
+private:
+	using IntersectionAlgorithm = BasicIntersectionAlgorithm<T>;
+	using CPoint = BasicCPoint<T>;
+	using CPosition = BasicCPosition<T>;
+	using CPositions = BasicCPositions<T>;
+	using CInterval = BasicCInterval<T>;
+	using CIntervals = BasicCIntervals<T>;
+	using Inputs = BasicInputs<T>;
+	using QSimpleInterval = BasicQSimpleInterval<T>;
+	using BoxData = BasicBoxData<T>;
+	using BoxScratch = BasicBoxScratch<T>;
+	using BoxTask = BasicBoxTask<T>;
+	using Filter = BasicFilter<T>;
+	using BoxNode = BasicBoxNode<T>;
+	using OpenOutput = BasicOpenOutput<T>;
+
 	using CurvePair = std::array<Curve const*, 2>;
 
 public:
-	static constexpr distance_t eps = 1e-10;
+	// precision of calcDistance
+	static constexpr distance_t eps = ScalarTraits<T>::light_eps;
+	// relative amount by which calcDistanceExact increases the tested distances;
+	// at a critical value, the passages have width zero and the decider only
+	// finds them up to the precision of the intersection algorithm
+	static constexpr distance_t critical_slack = ScalarTraits<T>::intersection_eps;
 	
-	FrechetLight() = default;
+	BasicFrechetLight() = default;
 	void buildFreespaceDiagram(distance_t distance, Curve const& curve1, Curve const& curve2);
 	bool lessThan(distance_t distance, Curve const& curve1, Curve const& curve2) override;
 	bool lessThanWithFilters(distance_t distance, Curve const& curve1, Curve const& curve2);
-	distance_t calcDistance(Curve const& curve1, Curve const& curve2);
+	// With max_distance, the search starts below it, and infinity is returned
+	// if the distance is larger, which costs at most one decider call.
+	distance_t calcDistance(Curve const& curve1, Curve const& curve2,
+		distance_t max_distance = std::numeric_limits<T>::infinity());
+	// Computes the Fréchet distance by searching the critical values of the
+	// free-space diagram instead of bisecting. The result is a critical value,
+	// i.e., it is exact up to the precision of the decider, and usually needs
+	// fewer decider calls than calcDistance.
+	distance_t calcDistanceExact(Curve const& curve1, Curve const& curve2);
+	// Returns a lower and an upper bound on the Fréchet distance with
+	// upper <= (1 + rel_eps)*lower, or upper - lower < eps if the distance is
+	// close to zero. The search starts at Filter::lowerBound, so the number of
+	// decider calls does not depend on the scale of the coordinates.
+	Interval calcDistanceApprox(Curve const& curve1, Curve const& curve2, distance_t rel_eps);
 	void clear();
 
+	// Use the given workspace instead of the own one, e.g., to pool the
+	// workspaces of several deciders. Passing nullptr switches back.
+	void setWorkspace(FrechetWorkspace* workspace) override;
+
 	CurvePair getCurvePair() const;
 	Certificate& computeCertificate() override;
 	const Certificate& getCertificate() const { return cert; } 
@@ -36,7 +86,34 @@ public:
 	void setPruningLevel(int pruning_level) override;
 	void setRules(std::array<bool,5> const& enable) override;
 
+	// Process single pairs of very long curves in parallel. The free-space
+	// diagram is cut into blocks of roughly block_size x block_size cells and
+	// the anti-diagonals of blocks are processed one after another, with the
+	// blocks of one anti-diagonal running in parallel. Only has an effect if
+	// OpenMP is available and neither CERTIFY nor VIS is defined.
+	void setParallel(bool parallel);
+	void setParallelBlockSize(std::size_t block_size);
+
+	// Let calcDistance decide num_candidates evenly spaced distances of the
+	// current bracket at once, each on its own thread, such that the bracket
+	// shrinks by a factor of num_candidates+1 per round instead of 2. The
+	// result only depends on num_candidates and not on the scheduling. 1, the
+	// default, is the sequential bisection. Only has an effect if OpenMP is
+	// available.
+	void setParallelSearch(std::size_t num_candidates);
+
+	// The order in which the boxes of the free-space diagram are processed.
+	// The answers are the same for all orders.
+	void setTraversalOrder(TraversalOrder order);
+
+	// Stop processing boxes as soon as the answer is settled, i.e., once the
+	// top right corner is reachable or once no remaining box can get a
+	// reachable input anymore. Enabled by default.
+	void setEarlyTermination(bool early_termination);
+
 	std::size_t getNumberOfBoxes() const;
+	// the number of boxes left in the work list when the decider terminated early
+	std::size_t getNumberOfSkippedBoxes() const;
 
 	std::size_t non_filtered = 0;
 
@@ -46,9 +123,11 @@ private:
 	distance_t distance;
 	distance_t dist_sqr;
 
-	std::vector<CIntervals> reachable_intervals_vec;
-	QSimpleIntervals qsimple_intervals;
-	std::size_t num_boxes;
+	// the workspace is either the own one or the one passed to setWorkspace
+	FrechetWorkspace own_workspace;
+	FrechetWorkspace* ws = &own_workspace;
+	std::size_t num_boxes = 0;
+	std::size_t num_skipped_boxes = 0;
 
 	// 0 = no pruning ... 6 = full pruning
 	int pruning_level = 6;
@@ -59,6 +138,26 @@ private:
 	bool enable_propagation2 = true;
 	bool enable_boundary_rule = true;
 
+	// intra-pair parallelization, see setParallel
+	bool parallel = false;
+	std::size_t parallel_block_size = 1024;
+	std::vector<std::unique_ptr<BasicFrechetLight>> workers;
+	// see setParallelSearch
+	std::size_t search_width = 1;
+
+	TraversalOrder traversal_order = TraversalOrder::DepthFirst;
+
+	// see setEarlyTermination
+	bool early_termination = true;
+
+	// The tree of boxes of the depth-first traversal, which carries the
+	// reachable parts of the outputs over between the distances of one
+	// calcDistance call.
+	std::vector<BoxNode> box_nodes;
+	std::vector<std::size_t> box_node_stack;
+	bool use_box_nodes = false;
+	std::vector<OpenOutput> open_outputs;
+
 #ifdef VIS
 	CIntervals unknown_intervals;
 	CIntervals connections;
@@ -94,33 +193,54 @@ private:
 	CPoint getLastReachablePoint(Point const& point, Curve const& curve) const;
 	bool isTopRightReachable(Outputs const& outputs) const;
 	void computeOutputs(Box const& initial_box, Inputs const& initial_inputs, Outputs& final_outputs);
+	void computeOutputsParallel(Inputs const& initial_inputs, Outputs& final_outputs);
+	void prepareWorker(BasicFrechetLight& worker) const;
+	// the rounds of calcDistance if setParallelSearch is used
+	void searchParallel(distance_t& min, distance_t& max, Curve const& curve1, Curve const& curve2);
 
+	// Processes the box and all its sub-boxes. Instead of recursing, the boxes
+	// are kept in an explicit work list in the workspace.
 	void getReachableIntervals(BoxData& data);
+	void processDepthFirst(BoxData const& root);
+	void processByPriority(BoxData const& root);
+	void resolvePendingInputs(BoxTask& task);
+	bool isTopRightSettled(Box const& box, Outputs const& root_outputs) const;
+	bool hasReachableInputs(BoxTask const& task) const;
+	bool isStackUnreachable() const;
+	// returns false if the box has to be split
+	bool processBox(BoxData& data);
 
-	// subfunctions of getReachableIntervals
-	bool emptyInputsRule(BoxData& data);
-	void boxShrinkingRule(BoxData& data);
-	void handleCellCase(BoxData& data);
-	void getQSimpleIntervals(BoxData& data);
-	void calculateQSimple1(BoxData& data);
-	void calculateQSimple2(BoxData& data);
-	bool boundaryPruningRule(BoxData& data);
-	void splitAndRecurse(BoxData& data);
-
-	// intervals used in getReachableIntervals and subfunctions
+	// work list handling
+	void splitBox(BoxTaskID id, BoxData const& data);
+	BoxTask splitInTwo(BoxData& data);
+	void splitInFour(BoxTaskID id, BoxData const& data);
+	BoxTaskID addSubTask(BoxTaskID parent, BoxData const& data,
+		CIntervalsID pending_input1, CIntervalsID pending_input2, std::size_t waiting_for);
+	void addDependency(BoxTaskID id, BoxTaskID dependent);
+	bool hasLowerPriority(BoxTaskID id1, BoxTaskID id2) const;
+	void pushReadyTask(BoxTaskID id);
+	BoxTaskID popReadyTask();
+	void finishTask(BoxTaskID id);
+
+	// subfunctions of processBox
+	bool emptyInputsRule(BoxData& data, BoxScratch& scratch);
+	void boxShrinkingRule(BoxData& data, BoxScratch& scratch);
+	void handleCellCase(BoxData& data, BoxScratch& scratch);
+	void getQSimpleIntervals(BoxData& data, BoxScratch& scratch);
+	void calculateQSimple1(BoxData& data, BoxScratch& scratch);
+	void calculateQSimple2(BoxData& data, BoxScratch& scratch);
+	bool boundaryPruningRule(BoxData& data, BoxScratch& scratch);
+
+	// the empty interval which is used if a box has no input on one side
 	CInterval const empty;
-	CInterval const* firstinterval1;
-	CInterval const* firstinterval2;
-	distance_t min1_frac, min2_frac;
-	QSimpleInterval qsimple1, qsimple2;
-	CInterval out1, out2;
-	// TODO: can those be made members of out1, out2?
-	bool out1_valid = false, out2_valid = false;
 
 	// qsimple interval calculation functions
 	QSimpleInterval getFreshQSimpleInterval(const Point& fixed_point, PointID min1, PointID max1, const Curve& curve) const;
 	bool updateQSimpleInterval(QSimpleInterval& qsimple, const Point& fixed_point, PointID min1, PointID max1, const Curve& curve) const;
 	void continueQSimpleSearch(QSimpleInterval& qsimple, const Point& fixed_point, PointID min1, PointID max1, const Curve& curve) const;
+	bool useKnownOutputs(BoxData& data, std::size_t node, std::size_t depth);
+	void closeOutputs(std::size_t depth);
+	std::size_t splitNode(std::size_t node, Box const& first, Box const& second);
 
 	bool isOnLowerRight(const CPosition& pt) const;
 	bool isOnUpperLeft(const CPosition& pt) const;
@@ -141,3 +261,10 @@ private:
 	// case in needing access to the internal structures.
 	friend class FreespaceLightVis;
 };
+
+template <typename T>
+constexpr T BasicFrechetLight<T>::eps;
+template <typename T>
+constexpr T BasicFrechetLight<T>::critical_slack;
+
+using FrechetLight = BasicFrechetLight<distance_t>;
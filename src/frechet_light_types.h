@@ -4,6 +4,8 @@
 #include "id.h"
 #include "curves.h"
 
+#include <array>
+#include <limits>
 #include <vector>
 
 //
@@ -22,18 +24,69 @@ struct Box {
 	bool isCell() const {
 		return max1 - min1 == 1 && max2 - min2 == 1;
 	}
+	bool operator==(Box const& other) const {
+		return min1 == other.min1 && max1 == other.max1 && min2 == other.min2 && max2 == other.max2;
+	}
 };
 using Boxes = std::vector<Box>;
 
+//
+// BoxNode
+//
+
+// A box of the depth-first traversal together with what is known about the
+// reachable parts of its outputs. The reachable space is monotone in the
+// distance. Thus, an output which contains no reachable point for some
+// distance does not contain any for smaller distances, and an output which is
+// completely reachable stays so for larger distances.
+//
+// A box is always split in the same way, so the nodes form a tree which can be
+// shared between the decider calls for several distances of one curve pair.
+// Only box shrinking can change the sub-boxes, in which case new children are
+// created.
+template <typename T>
+struct BasicBoxNode {
+	Box box;
+	// the first of the two children; the root is never a child, so 0 means
+	// that the box was not split yet
+	std::size_t children = 0;
+
+	// the largest distance for which the top/right output is known to be
+	// unreachable and the smallest for which it is known to be reachable
+	std::array<T, 2> unreachable_up_to{{std::numeric_limits<T>::lowest(), std::numeric_limits<T>::lowest()}};
+	std::array<T, 2> reachable_from{{std::numeric_limits<T>::max(), std::numeric_limits<T>::max()}};
+
+	BasicBoxNode(Box const& box) : box(box) {}
+};
+
+// An output of a box which is not finished yet. It is used to check whether
+// the box and its sub-boxes added reachable intervals to the output.
+template <typename T>
+struct BasicOpenOutput {
+	std::size_t node;
+	// 0 for the top and 1 for the right output
+	std::size_t side;
+	CIntervalsID intervals;
+	// the size of the output intervals and the end of the last one when the
+	// box was started
+	std::size_t size;
+	BasicCPoint<T> last;
+	// the size of the work list when the box was started
+	std::size_t depth;
+};
+
 //
 // Inputs
 //
 
-struct Inputs {
-	CIntervals::iterator begin1;
-	CIntervals::iterator end1;
-	CIntervals::iterator begin2;
-	CIntervals::iterator end2;
+template <typename T>
+struct BasicInputs {
+	using Iterator = typename BasicCIntervals<T>::iterator;
+
+	Iterator begin1;
+	Iterator end1;
+	Iterator begin2;
+	Iterator end2;
 
 	bool haveDownInput() const { return begin1 != end1; }
 	bool haveLeftInput() const { return begin2 != end2; }
@@ -55,6 +108,7 @@ struct Inputs {
 		return false;
 	}
 };
+using Inputs = BasicInputs<distance_t>;
 
 //
 // Outputs
@@ -69,10 +123,14 @@ struct Outputs {
 // QSimpleInterval
 //
 
-struct QSimpleInterval
+template <typename T>
+struct BasicQSimpleInterval
 {
-	QSimpleInterval() : valid(false) {}
-	QSimpleInterval(CPoint const& begin, CPoint const& end)
+	using CPoint = BasicCPoint<T>;
+	using CInterval = BasicCInterval<T>;
+
+	BasicQSimpleInterval() : valid(false) {}
+	BasicQSimpleInterval(CPoint const& begin, CPoint const& end)
 		: valid(true), free(begin, end) {}
 
 	void setFreeInterval(CPoint const& begin, CPoint const& end) {
@@ -143,7 +201,11 @@ private:
 #endif
 };
 
-using QSimpleIntervals = std::vector<QSimpleInterval>;
+template <typename T>
+using BasicQSimpleIntervals = std::vector<BasicQSimpleInterval<T>>;
+
+using QSimpleInterval = BasicQSimpleInterval<distance_t>;
+using QSimpleIntervals = BasicQSimpleIntervals<distance_t>;
 using QSimpleID = ID<QSimpleInterval>;
 
 //
@@ -160,9 +222,69 @@ struct QSimpleOutputs
 // BoxData
 //
 
-struct BoxData {
+template <typename T>
+struct BasicBoxData {
 	Box box;
-	Inputs inputs;
+	BasicInputs<T> inputs;
 	Outputs outputs;
 	QSimpleOutputs qsimple_outputs;
 };
+using BoxData = BasicBoxData<distance_t>;
+
+//
+// BoxScratch
+//
+
+// Intermediate results of a single box which are passed between the
+// subfunctions of FrechetLight::getReachableIntervals.
+template <typename T>
+struct BasicBoxScratch {
+	BasicCInterval<T> const* firstinterval1;
+	BasicCInterval<T> const* firstinterval2;
+	T min1_frac, min2_frac;
+	BasicQSimpleInterval<T> qsimple1, qsimple2;
+	BasicCInterval<T> out1, out2;
+	// TODO: can those be made members of out1, out2?
+	bool out1_valid = false, out2_valid = false;
+};
+using BoxScratch = BasicBoxScratch<distance_t>;
+
+//
+// BoxTask
+//
+
+template <typename T>
+struct BasicBoxTask;
+using BoxTaskID = ID<BasicBoxTask<distance_t>>;
+using BoxTaskIDs = std::vector<BoxTaskID>;
+
+// A box in the explicit work list of FrechetLight. Inputs which are produced by
+// a sibling box are only resolved when the task is processed, as the
+// corresponding interval list is still growing before. A task is finished once
+// the box and all of its sub-boxes are processed; this is only tracked for
+// traversal orders other than TraversalOrder::DepthFirst.
+template <typename T>
+struct BasicBoxTask {
+	BasicBoxData<T> data;
+	CIntervalsID pending_input1;
+	CIntervalsID pending_input2;
+
+	BoxTaskID parent;
+	std::size_t unfinished_children;
+	// the tasks which wait for this one to finish
+	std::array<BoxTaskID, 2> dependents;
+	std::size_t waiting_for;
+};
+using BoxTask = BasicBoxTask<distance_t>;
+
+// The order in which FrechetLight processes the boxes which are ready. Boxes
+// are only ready once all the boxes they take their inputs from are finished.
+//
+// DepthFirst splits boxes into two halves and processes them like a recursion
+// would. The other orders split boxes into four quarters, such that the lower
+// right and the upper left quarter can be processed in either order.
+enum class TraversalOrder {
+	DepthFirst,
+	LargestFirst, // largest box area first
+	AntiDiagonal, // smallest min1 + min2 first, i.e., sweep from the lower left
+};
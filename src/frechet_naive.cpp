@@ -6,7 +6,8 @@
 #include <vector>
 #include <limits>
 
-bool FrechetNaive::lessThan(distance_t distance, Curve const& curve1, Curve const& curve2)
+template <typename T>
+bool BasicFrechetNaive<T>::lessThan(distance_t distance, Curve const& curve1, Curve const& curve2)
 {
 	assert(curve1.size() >= 2);
 	assert(curve2.size() >= 2);
@@ -27,10 +28,22 @@ bool FrechetNaive::lessThan(distance_t distance, Curve const& curve1, Curve cons
 		if (curve1[0].dist_sqr(curve2[j+1]) > dist_sqr) { break; }
 	}
 
+	// the free intervals are computed in batches: free1[j] holds the ones of
+	// curve2[j] with all segments of curve1, free2 the ones of curve1[i] with
+	// all segments of curve2.
+	std::vector<std::vector<Interval>> free1(curve2.size(), std::vector<Interval>(curve1.size()-1));
+	for (size_t j = 1; j < curve2.size(); ++j) {
+		IntersectionAlgorithm::intersection_intervals(curve2[j], distance, &curve1[0], curve1.size()-1, free1[j].data());
+	}
+	std::vector<Interval> free2(curve2.size()-1);
+
 	for (size_t i = 0; i < curve1.size(); ++i) {
+		if (i > 0) {
+			IntersectionAlgorithm::intersection_intervals(curve1[i], distance, &curve2[0], curve2.size()-1, free2.data());
+		}
 		for (size_t j = 0; j < curve2.size(); ++j) {
 			if (i < curve1.size() - 1 && j > 0) {
-				Interval free_int = IntersectionAlgorithm::intersection_interval(curve2[j], distance, curve1[i], curve1[i+1]);
+				Interval const& free_int = free1[j][i];
 				if (!free_int.is_empty()) {
 					if (reachable2[i][j-1] != infty) {
 						reachable1[i][j] = free_int.begin;
@@ -41,7 +54,7 @@ bool FrechetNaive::lessThan(distance_t distance, Curve const& curve1, Curve cons
 				}
 			}
 			if (j < curve2.size() - 1 && i > 0) {
-				Interval free_int = IntersectionAlgorithm::intersection_interval(curve1[i], distance, curve2[j], curve2[j+1]);
+				Interval const& free_int = free2[j];
 				if (!free_int.is_empty()) {
 					if (reachable1[i-1][j] != infty) {
 						reachable2[i][j] = free_int.begin;
@@ -59,7 +72,8 @@ bool FrechetNaive::lessThan(distance_t distance, Curve const& curve1, Curve cons
 	return reachable1.back().back() < infty;
 }
 
-bool FrechetNaive::lessThanWithFilters(distance_t distance, Curve const& curve1, Curve const& curve2)
+template <typename T>
+bool BasicFrechetNaive<T>::lessThanWithFilters(distance_t distance, Curve const& curve1, Curve const& curve2)
 {
 	assert(curve1.size());
 	assert(curve2.size());
@@ -73,7 +87,7 @@ bool FrechetNaive::lessThanWithFilters(distance_t distance, Curve const& curve1,
 		return true;
 	}
 
-	Filter filter(curve1, curve2, distance);
+	BasicFilter<T> filter(curve1, curve2, distance);
 
 
 	if (filter.bichromaticFarthestDistance()) {
@@ -94,3 +108,6 @@ bool FrechetNaive::lessThanWithFilters(distance_t distance, Curve const& curve1,
 
 	return lessThan(distance, curve1, curve2);
 }
+
+template class BasicFrechetNaive<float>;
+template class BasicFrechetNaive<double>;
@@ -5,10 +5,15 @@
 #include "geometry_basics.h"
 #include "curves.h"
 
-class FrechetNaive final : public FrechetAbstract
+template <typename T>
+class BasicFrechetNaive final : public BasicFrechetAbstract<T>
 {
 public:
-	FrechetNaive() {
+	using distance_t = T;
+	using Curve = BasicCurve<T>;
+	using Certificate = BasicCertificate<T>;
+
+	BasicFrechetNaive() {
 		std::cout << "Initializing FrechetNaive algorithm...\n";
 	}; // = default;
 	bool lessThan(distance_t distance, Curve const& curve1, Curve const& curve2);
@@ -16,5 +21,10 @@ public:
 	Certificate&  computeCertificate() { return cert; }
 
 private:
+	using Interval = BasicInterval<T>;
+	using IntersectionAlgorithm = BasicIntersectionAlgorithm<T>;
+
 	Certificate cert;
 };
+
+using FrechetNaive = BasicFrechetNaive<distance_t>;
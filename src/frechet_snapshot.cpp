@@ -0,0 +1,79 @@
+#include "defs.h"
+#include "query.h"
+
+#include <chrono>
+#include <string>
+
+void printUsage()
+{
+	std::cout <<
+		"Usage: ./frechet_snapshot [--float] [--collection] <curve_directory> <curve_data_file> <snapshot_file> [<num_kd_pivots>]\n"
+		"\n"
+		"Reads the curves of the data set, builds the kd-tree, and writes both to\n"
+		"the binary <snapshot_file>. Pass it to ./frechet with --snapshot instead\n"
+		"of <curve_data_file> to start querying without parsing the curves or\n"
+		"building the tree. The snapshot can only be read with the same precision\n"
+		"and on a machine of the same byte order.\n"
+		"\n"
+		"With <num_kd_pivots>, the distances to that many pivot points are added\n"
+		"as coordinates to the kd-tree (at most 8, default 0). With --collection,\n"
+		"<curve_data_file> is a single file with all curves of the data set, see\n"
+		"./create_curve_collection.\n"
+		"\n";
+}
+
+template <typename T>
+void writeSnapshot(std::string const& curve_directory, std::string const& curve_data_file,
+	std::string const& snapshot_file, std::size_t num_kd_pivots, bool use_collection)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	BasicQuery<T> query(curve_directory);
+	if (use_collection) {
+		query.readCurveCollection(curve_data_file);
+	}
+	else {
+		query.readCurveData(curve_data_file);
+	}
+	std::chrono::duration<double> read_time = std::chrono::steady_clock::now() - start;
+
+	query.setNumberOfKdPivots(num_kd_pivots);
+	query.getReady();
+	query.writeSnapshot(snapshot_file);
+	std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+
+	std::cout << "Number of curves: " << query.getCurves().size() << "\n";
+	std::cout << "Read time: " << read_time.count() << " s\n";
+	std::cout << "Total time: " << time.count() << " s\n";
+}
+
+int main(int argc, char* argv[])
+{
+	bool use_float = (argc > 1 && std::string(argv[1]) == "--float");
+	if (use_float) {
+		--argc;
+		++argv;
+	}
+	bool use_collection = (argc > 1 && std::string(argv[1]) == "--collection");
+	if (use_collection) {
+		--argc;
+		++argv;
+	}
+
+	if (argc != 4 && argc != 5) {
+		printUsage();
+		ERROR("Wrong number of arguments passed.");
+	}
+
+	std::string curve_directory(argv[1]);
+	std::string curve_data_file(argv[2]);
+	std::string snapshot_file(argv[3]);
+	std::size_t num_kd_pivots = (argc == 5 ? std::stoul(argv[4]) : 0);
+
+	if (use_float) {
+		writeSnapshot<float>(curve_directory, curve_data_file, snapshot_file, num_kd_pivots, use_collection);
+	}
+	else {
+		writeSnapshot<double>(curve_directory, curve_data_file, snapshot_file, num_kd_pivots, use_collection);
+	}
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "defs.h"
+#include "filter.h"
+#include "frechet_light_types.h"
+#include "geometry_basics.h"
+#include "id.h"
+
+#include <vector>
+
+// Holds the memory which FrechetLight needs during a call of lessThan. The
+// interval lists and the box tasks are never freed but recycled in the next
+// call, i.e., after a few warm-up calls, the decider does not allocate anymore.
+// Resetting the workspace between two calls is O(1). The same holds for the
+// filter which is run on the candidates before the decider.
+//
+// A workspace can only be used by one decider call at a time. Callers which
+// run several deciders in parallel should therefore own one workspace per
+// thread (see Query::ThreadData).
+template <typename T>
+class BasicFrechetWorkspace
+{
+public:
+	using CIntervals = BasicCIntervals<T>;
+	using QSimpleInterval = BasicQSimpleInterval<T>;
+	using QSimpleIntervals = BasicQSimpleIntervals<T>;
+	using BoxTask = BasicBoxTask<T>;
+	using Curve = BasicCurve<T>;
+	using Filter = BasicFilter<T>;
+
+	BasicFrechetWorkspace() = default;
+	BasicFrechetWorkspace(BasicFrechetWorkspace const& other) = delete;
+	BasicFrechetWorkspace& operator=(BasicFrechetWorkspace const& other) = delete;
+
+	void reset()
+	{
+		num_intervals = 0;
+		qsimple_intervals.clear();
+		task_stack.clear();
+		tasks.clear();
+		free_tasks.clear();
+		ready_tasks.clear();
+	}
+
+	// Returns the ID of an empty interval list. Lists which were used in a
+	// previous call are only cleared here, such that their capacity is kept.
+	CIntervalsID newIntervals()
+	{
+		if (num_intervals == intervals_pool.size()) {
+			intervals_pool.emplace_back();
+		}
+		intervals_pool[num_intervals].clear();
+
+		return num_intervals++;
+	}
+	CIntervals& getIntervals(CIntervalsID id)
+	{
+		assert(id < num_intervals);
+		return intervals_pool[id];
+	}
+	CIntervals const& getIntervals(CIntervalsID id) const
+	{
+		assert(id < num_intervals);
+		return intervals_pool[id];
+	}
+	std::size_t getNumberOfIntervals() const { return num_intervals; }
+
+	QSimpleID addQSimpleInterval(QSimpleInterval const& qsimple)
+	{
+		qsimple_intervals.push_back(qsimple);
+		return qsimple_intervals.size() - 1;
+	}
+	QSimpleInterval const& getQSimpleInterval(QSimpleID id) const
+	{
+		return qsimple_intervals[id];
+	}
+
+	// The stack of the depth-first traversal.
+	std::vector<BoxTask>& getTaskStack() { return task_stack; }
+	std::vector<BoxTask> const& getTaskStack() const { return task_stack; }
+
+	// The task slots of the other traversal orders. Finished tasks are
+	// recycled, so the number of slots is bounded by the number of boxes which
+	// are alive at the same time.
+	BoxTaskID newTask(BoxTask const& task)
+	{
+		if (!free_tasks.empty()) {
+			BoxTaskID id = free_tasks.back();
+			free_tasks.pop_back();
+			tasks[id] = task;
+			return id;
+		}
+		tasks.push_back(task);
+		return tasks.size() - 1;
+	}
+	BoxTask& getTask(BoxTaskID id)
+	{
+		assert(id < tasks.size());
+		return tasks[id];
+	}
+	void freeTask(BoxTaskID id) { free_tasks.push_back(id); }
+
+	// the tasks which can be processed, as a heap ordered by the decider
+	BoxTaskIDs& getReadyTasks() { return ready_tasks; }
+
+	// The filter for the curves; it is valid until the next call, and the
+	// traversal of its certificate keeps its memory.
+	Filter& getFilter(Curve const& curve1, Curve const& curve2, T distance)
+	{
+		filter.reset(curve1, curve2, distance);
+		return filter;
+	}
+
+private:
+	// Only the first num_intervals lists are in use, the others are kept for
+	// later calls.
+	std::vector<CIntervals> intervals_pool;
+	std::size_t num_intervals = 0;
+
+	QSimpleIntervals qsimple_intervals;
+
+	std::vector<BoxTask> task_stack;
+	std::vector<BoxTask> tasks;
+	BoxTaskIDs free_tasks;
+	BoxTaskIDs ready_tasks;
+
+	Filter filter;
+};
+
+using FrechetWorkspace = BasicFrechetWorkspace<distance_t>;
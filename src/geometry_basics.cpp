@@ -1,5 +1,7 @@
 #include "geometry_basics.h"
 
+#include "geometry_simd.h"
+
 namespace
 {
 
@@ -12,14 +14,16 @@ T pow2(T d) { return std::pow(d, 2); }
 // Point
 //
 
-Point& Point::operator-=(const Point& point)
+template <typename T>
+BasicPoint<T>& BasicPoint<T>::operator-=(const BasicPoint& point)
 {
     x -= point.x;
     y -= point.y;
     return *this;
 }
 
-Point Point::operator-(const Point& point) const
+template <typename T>
+BasicPoint<T> BasicPoint<T>::operator-(const BasicPoint& point) const
 {
     auto result = *this;
 	result -= point; 
@@ -27,14 +31,16 @@ Point Point::operator-(const Point& point) const
     return result;
 }
 
-Point& Point::operator+=(const Point& point)
+template <typename T>
+BasicPoint<T>& BasicPoint<T>::operator+=(const BasicPoint& point)
 {
     x += point.x;
     y += point.y;
     return *this;
 }
 
-Point Point::operator+(const Point& point) const
+template <typename T>
+BasicPoint<T> BasicPoint<T>::operator+(const BasicPoint& point) const
 {
     auto result = *this;
 	result += point; 
@@ -42,32 +48,37 @@ Point Point::operator+(const Point& point) const
     return result;
 }
 
-Point Point::operator*(const distance_t mult) const
+template <typename T>
+BasicPoint<T> BasicPoint<T>::operator*(const distance_t mult) const
 {
-	Point res;
+	BasicPoint res;
 	res.x = mult * this->x;
 	res.y = mult * this->y;
     return res;
 }
 
-Point& Point::operator/=(distance_t distance)
+template <typename T>
+BasicPoint<T>& BasicPoint<T>::operator/=(distance_t distance)
 {
     x /= distance;
     y /= distance;
     return *this;
 }
 
-distance_t Point::dist_sqr(const Point& point) const
+template <typename T>
+T BasicPoint<T>::dist_sqr(const BasicPoint& point) const
 {
     return pow2(x - point.x) + pow2(y - point.y);
 }
 
-distance_t Point::dist(const Point& point) const
+template <typename T>
+T BasicPoint<T>::dist(const BasicPoint& point) const
 {
     return std::sqrt(dist_sqr(point));
 }
 
-std::ostream& operator<<(std::ostream& out, const Point& p)
+template <typename T>
+std::ostream& operator<<(std::ostream& out, const BasicPoint<T>& p)
 {
     out << std::setprecision (15)
 		<< "(" << p.x << ", " << p.y << ")";
@@ -75,19 +86,12 @@ std::ostream& operator<<(std::ostream& out, const Point& p)
     return out;
 }
 
-std::ostream& operator<<(std::ostream& out, const CPoint& p)
-{
-    out << std::setprecision (15)
-		<< "(" << (size_t) p.point << " + " << p.fraction << ")";
-
-    return out;
-}
-
 //
 // Interval
 //
 
-std::ostream& operator<<(std::ostream& out, const Interval& interval)
+template <typename T>
+std::ostream& operator<<(std::ostream& out, const BasicInterval<T>& interval)
 {
     out << std::setprecision (15)
 		<< "(" << interval.begin << ", " << interval.end << ")";
@@ -95,7 +99,8 @@ std::ostream& operator<<(std::ostream& out, const Interval& interval)
     return out;
 }
 
-std::ostream& operator<<(std::ostream& out, const CInterval& interval)
+template <typename T>
+std::ostream& operator<<(std::ostream& out, const BasicCInterval<T>& interval)
 {
     out << std::setprecision (15)
 		<< "(" << interval.begin << ", " << interval.end << ")";
@@ -107,15 +112,18 @@ std::ostream& operator<<(std::ostream& out, const CInterval& interval)
 // intersection_interval
 //
 
-inline bool IntersectionAlgorithm::smallDistanceAt(distance_t interpolate, Point line_start, Point line_end, Point circle_center, distance_t radius_sqr) {
+template <typename T>
+inline bool BasicIntersectionAlgorithm<T>::smallDistanceAt(distance_t interpolate, Point line_start, Point line_end, Point circle_center, distance_t radius_sqr) {
 	return circle_center.dist_sqr(line_start * (1. - interpolate) + line_end * interpolate) <= radius_sqr;
 }
 
-inline distance_t IntersectionAlgorithm::distanceAt(distance_t interpolate, Point line_start, Point line_end, Point circle_center) {
+template <typename T>
+inline T BasicIntersectionAlgorithm<T>::distanceAt(distance_t interpolate, Point line_start, Point line_end, Point circle_center) {
 	return circle_center.dist_sqr(line_start * (1. - interpolate) + line_end * interpolate);
 }
 
-Interval IntersectionAlgorithm::intersection_interval(Point circle_center, distance_t radius, Point line_start, Point line_end, Interval * outer /* = nullptr*/)
+template <typename T>
+auto BasicIntersectionAlgorithm<T>::intersection_interval(Point circle_center, distance_t radius, Point line_start, Point line_end, Interval * outer /* = nullptr*/) -> Interval
 {
     // The line can be represented as line_start + lambda * v
     const Point v = line_end - line_start;
@@ -272,6 +280,108 @@ Interval IntersectionAlgorithm::intersection_interval(Point circle_center, dista
 	return Interval{ begin, end };
 }
 
+template <typename T>
+void BasicIntersectionAlgorithm<T>::intersection_intervals(Point circle_center, distance_t radius, Point const* points, std::size_t count, Interval* intervals, Interval* outers /* = nullptr*/)
+{
+	for (std::size_t i = 0; i < count; ++i) {
+		intervals[i] = intersection_interval(circle_center, radius, points[i], points[i+1],
+			outers == nullptr ? nullptr : &outers[i]);
+	}
+}
+
+// The SIMD kernels only exist for double.
+template <>
+void BasicIntersectionAlgorithm<double>::intersection_intervals(Point circle_center, distance_t radius, Point const* points, std::size_t count, Interval* intervals, Interval* outers /* = nullptr*/)
+{
+	static simd::IntersectionKernel const kernel = simd::getIntersectionKernel();
+
+	// Point and Interval both consist of two doubles
+	static_assert(sizeof(Point) == 2*sizeof(double) && sizeof(Interval) == 2*sizeof(double), "unexpected layout");
+
+	constexpr std::size_t chunk_size = 64;
+	bool fallback[chunk_size];
+
+	for (std::size_t first = 0; first < count; first += chunk_size) {
+		std::size_t size = std::min(chunk_size, count - first);
+		std::size_t done = 0;
+		if (kernel != nullptr) {
+			done = kernel(circle_center.x, circle_center.y, radius,
+				reinterpret_cast<double const*>(points + first), size,
+				reinterpret_cast<double*>(intervals + first),
+				outers == nullptr ? nullptr : reinterpret_cast<double*>(outers + first),
+				fallback, eps, save_eps_half);
+		}
+
+		for (std::size_t k = 0; k < size; ++k) {
+			if (k >= done || fallback[k]) {
+				auto i = first + k;
+				intervals[i] = intersection_interval(circle_center, radius, points[i], points[i+1],
+					outers == nullptr ? nullptr : &outers[i]);
+			}
+		}
+	}
+}
+
+//
+// Critical values
+//
+
+template <typename T>
+T segmentDistance(BasicPoint<T> const& point, BasicPoint<T> const& line_start, BasicPoint<T> const& line_end)
+{
+	auto const direction = line_end - line_start;
+	auto const length_sqr = direction.x*direction.x + direction.y*direction.y;
+	if (length_sqr == 0) {
+		return point.dist(line_start);
+	}
+
+	auto const diff = point - line_start;
+	auto t = (diff.x*direction.x + diff.y*direction.y) / length_sqr;
+	t = std::max<T>(0, std::min<T>(1, t));
+
+	return point.dist(line_start + direction*t);
+}
+
+template <typename T>
+bool bisectorDistance(BasicPoint<T> const& point1, BasicPoint<T> const& point2,
+	BasicPoint<T> const& line_start, BasicPoint<T> const& line_end, T& distance)
+{
+	// solve (line_start + t*direction - middle) * normal = 0 for t
+	auto const direction = line_end - line_start;
+	auto const normal = point2 - point1;
+	auto const middle = (point1 + point2)*0.5;
+
+	auto const denominator = direction.x*normal.x + direction.y*normal.y;
+	if (denominator == 0) {
+		return false;
+	}
+	auto const diff = middle - line_start;
+	auto const t = (diff.x*normal.x + diff.y*normal.y) / denominator;
+	if (t < 0 || t > 1) {
+		return false;
+	}
+
+	distance = point1.dist(line_start + direction*t);
+	return true;
+}
+
+template struct BasicPoint<float>;
+template struct BasicPoint<double>;
+template std::ostream& operator<<(std::ostream& out, const BasicPoint<float>& p);
+template std::ostream& operator<<(std::ostream& out, const BasicPoint<double>& p);
+template std::ostream& operator<<(std::ostream& out, const BasicInterval<float>& interval);
+template std::ostream& operator<<(std::ostream& out, const BasicInterval<double>& interval);
+template std::ostream& operator<<(std::ostream& out, const BasicCInterval<float>& interval);
+template std::ostream& operator<<(std::ostream& out, const BasicCInterval<double>& interval);
+template class BasicIntersectionAlgorithm<float>;
+template class BasicIntersectionAlgorithm<double>;
+template float segmentDistance(BasicPoint<float> const&, BasicPoint<float> const&, BasicPoint<float> const&);
+template double segmentDistance(BasicPoint<double> const&, BasicPoint<double> const&, BasicPoint<double> const&);
+template bool bisectorDistance(BasicPoint<float> const&, BasicPoint<float> const&,
+	BasicPoint<float> const&, BasicPoint<float> const&, float&);
+template bool bisectorDistance(BasicPoint<double> const&, BasicPoint<double> const&,
+	BasicPoint<double> const&, BasicPoint<double> const&, double&);
+
 Ellipse segmentsToEllipse(Point const& a1, Point const& b1, Point const& a2, Point const& b2, distance_t distance)
 {
 	Ellipse e;
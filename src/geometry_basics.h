@@ -17,30 +17,66 @@ namespace unit_tests { void testGeometricBasics(); }
 // distance_t
 //
 
+// The geometric types and the algorithms are templates on the scalar type of
+// the coordinates (Basic* classes), which are instantiated for float and
+// double. The plain names (Point, Curve, FrechetLight, ...) are the double
+// versions.
 using distance_t = double;
 
+// Constants which depend on the precision of the scalar type.
+template <typename T>
+struct ScalarTraits;
+
+template <>
+struct ScalarTraits<double>
+{
+	// see IntersectionAlgorithm::eps
+	static constexpr double intersection_eps = 1e-8;
+	// see FrechetLight::eps
+	static constexpr double light_eps = 1e-10;
+};
+
+template <>
+struct ScalarTraits<float>
+{
+	// The values for double scaled by the square root of the ratio of the
+	// machine epsilons, as the intersection of a circle with a segment is only
+	// that precise close to a tangent.
+	static constexpr float intersection_eps = 2.5e-4f;
+	static constexpr float light_eps = 2.5e-6f;
+};
+
 //
 // Point
 //
 
-struct Point {
+template <typename T>
+struct BasicPoint {
+	using distance_t = T;
+
     distance_t x;
     distance_t y;
 
-	Point& operator-=(const Point& point);
-	Point operator-(const Point& point) const;
-	Point& operator+=(const Point& point);
-	Point operator+(const Point& point) const;
-	Point operator*(const distance_t mult) const;
-	Point& operator/=(distance_t distance);
+	BasicPoint& operator-=(const BasicPoint& point);
+	BasicPoint operator-(const BasicPoint& point) const;
+	BasicPoint& operator+=(const BasicPoint& point);
+	BasicPoint operator+(const BasicPoint& point) const;
+	BasicPoint operator*(const distance_t mult) const;
+	BasicPoint& operator/=(distance_t distance);
 
-	distance_t dist_sqr(const Point& point) const;
-	distance_t dist(const Point& point) const;
+	distance_t dist_sqr(const BasicPoint& point) const;
+	distance_t dist(const BasicPoint& point) const;
 };
-using Points = std::vector<Point>;
+template <typename T>
+using BasicPoints = std::vector<BasicPoint<T>>;
+
+using Point = BasicPoint<distance_t>;
+using Points = BasicPoints<distance_t>;
+// IDs are only indices, so they are the same for all scalar types
 using PointID = ID<Point>;
 
-std::ostream& operator<<(std::ostream& out, const Point& p);
+template <typename T>
+std::ostream& operator<<(std::ostream& out, const BasicPoint<T>& p);
 
 struct PointRange {
 	PointID begin;
@@ -107,25 +143,28 @@ BFDirection toBFDirection(Direction direction);
 // Interval
 //
 
-struct Interval
+template <typename T>
+struct BasicInterval
 {
+	using distance_t = T;
+
 	distance_t begin;
 	distance_t end;
 
-	Interval()
+	BasicInterval()
 		: begin(1.),
 		  end(0.) {}
 
-	Interval(distance_t begin, distance_t end)
+	BasicInterval(distance_t begin, distance_t end)
 		: begin(begin),
 		  end(end) {}
 
-	bool operator<(Interval const& other) const {
+	bool operator<(BasicInterval const& other) const {
 		return begin < other.begin || (begin == other.begin && end < other.end);
 	}
 
 	bool is_empty() const { return begin > end; }
-	bool intersects(Interval const& other) const
+	bool intersects(BasicInterval const& other) const
 	{
 		if (is_empty() || other.is_empty()) { return false; }
 
@@ -134,15 +173,24 @@ struct Interval
 			(other.begin <= begin && other.end >= end);
 	}
 };
-using Intervals = std::vector<Interval>;
+template <typename T>
+using BasicIntervals = std::vector<BasicInterval<T>>;
+
+using Interval = BasicInterval<distance_t>;
+using Intervals = BasicIntervals<distance_t>;
 
-std::ostream& operator<<(std::ostream& out, const Interval& interval);
+template <typename T>
+std::ostream& operator<<(std::ostream& out, const BasicInterval<T>& interval);
 
 
 // Data Types for FrechetLight:
 
 
-class CPoint {
+template <typename T>
+class BasicCPoint {
+public:
+	using distance_t = T;
+
 private:
 	PointID point;
 	distance_t fraction;
@@ -155,12 +203,12 @@ private:
 		}
 	}
 public:
-	CPoint(PointID point, distance_t fraction)
+	BasicCPoint(PointID point, distance_t fraction)
 		: point(point), fraction(fraction)
 	{
 			normalize();
 	}
-	CPoint() : point(std::numeric_limits<PointID::IDType>::max()), fraction(0.) {}
+	BasicCPoint() : point(std::numeric_limits<PointID::IDType>::max()), fraction(0.) {}
 	
 	PointID getPoint() const { return point; } 
 	distance_t getFraction() const { return fraction; } 
@@ -168,22 +216,22 @@ public:
 	void setPoint(PointID point) { this->point = point; }
 	void setFraction(distance_t frac) { fraction = frac; normalize(); }
 		
-	bool operator<(CPoint const& other) const {
+	bool operator<(BasicCPoint const& other) const {
 		return point < other.point || (point == other.point && fraction < other.fraction);
 	}
-	bool operator<=(CPoint const& other) const {
+	bool operator<=(BasicCPoint const& other) const {
 		return point < other.point || (point == other.point && fraction <= other.fraction);
 	}
-	bool operator>(CPoint const& other) const {
+	bool operator>(BasicCPoint const& other) const {
 		return point > other.point || (point == other.point && fraction > other.fraction);
 	}
-	bool operator>=(CPoint const& other) const {
+	bool operator>=(BasicCPoint const& other) const {
 		return point > other.point || (point == other.point && fraction >= other.fraction);
 	}
-	bool operator==(CPoint const& other) const {
+	bool operator==(BasicCPoint const& other) const {
 		return point == other.point && fraction == other.fraction;
 	}
-	bool operator!=(CPoint const& other) const {
+	bool operator!=(BasicCPoint const& other) const {
 		return point != other.point or fraction != other.fraction;
 	}
 	bool operator<(PointID other) const {
@@ -204,27 +252,27 @@ public:
 	bool operator!=(size_t other) const {
 		return !(point == other);
 	}
-	CPoint operator+(distance_t other) const { 
+	BasicCPoint operator+(distance_t other) const { 
 	  assert(other <= 1.);
 	  PointID p = point; distance_t f = fraction + other; 
 	  if (f > 1.) {
 	    ++p; f -= 1.;
 	  } 
-	  return CPoint(p, f); 
+	  return BasicCPoint(p, f); 
 	}
-	CPoint operator-(distance_t other) const { 
+	BasicCPoint operator-(distance_t other) const { 
 	  assert(other <= 1.);
 	  PointID p = point; distance_t f = fraction - other; 
 	  if (f < 0.) {
 	    --p; f += 1.;
 	  } 
-	  return CPoint(p, f); 
+	  return BasicCPoint(p, f); 
 	}
-	CPoint ceil() const {
-		return fraction > 0 ? CPoint(point + 1, 0.) : CPoint(point, 0.);
+	BasicCPoint ceil() const {
+		return fraction > 0 ? BasicCPoint(point + 1, 0.) : BasicCPoint(point, 0.);
 	}
-	CPoint floor() const {
-		return CPoint(point, 0.);
+	BasicCPoint floor() const {
+		return BasicCPoint(point, 0.);
 	}
 	std::string to_string() const { 
 	  //return std::to_string( (double) point + fraction); 
@@ -233,30 +281,52 @@ public:
 	  return stream.str();
 	}
 
-	friend std::ostream& operator<<(std::ostream& out, const CPoint& p);
+	friend std::ostream& operator<<(std::ostream& out, const BasicCPoint& p)
+	{
+		out << std::setprecision (15)
+			<< "(" << (size_t) p.point << " + " << p.fraction << ")";
+
+		return out;
+	}
 };
+using CPoint = BasicCPoint<distance_t>;
 
-struct CInterval;
-using CIntervals = std::vector<CInterval>;
+
+template <typename T>
+struct BasicCInterval;
+template <typename T>
+using BasicCIntervals = std::vector<BasicCInterval<T>>;
+using CIntervals = BasicCIntervals<distance_t>;
 using CIntervalsID = ID<CIntervals>;
 using CIntervalID = std::size_t;
 using CIntervalIDs = std::vector<CIntervalID>;
 
-using CPoints = std::vector<CPoint>;
+template <typename T>
+using BasicCPoints = std::vector<BasicCPoint<T>>;
+using CPoints = BasicCPoints<distance_t>;
 
-using CPosition = std::array<CPoint, 2>;
-using CPositions = std::vector<CPosition>;
+template <typename T>
+using BasicCPosition = std::array<BasicCPoint<T>, 2>;
+template <typename T>
+using BasicCPositions = std::vector<BasicCPosition<T>>;
+using CPosition = BasicCPosition<distance_t>;
+using CPositions = BasicCPositions<distance_t>;
 
 using CurveID = std::size_t;
 using CurveIDs = std::vector<CurveID>;
 
-struct CInterval
+template <typename T>
+struct BasicCInterval
 {
+	using distance_t = T;
+	using CPoint = BasicCPoint<T>;
+	using CPosition = BasicCPosition<T>;
+
 	CPoint begin;
 	CPoint end;
 
 #ifdef CERTIFY
-	const CInterval* reach_parent = nullptr; 
+	const BasicCInterval* reach_parent = nullptr; 
 	CPoint fixed = CPoint(std::numeric_limits<PointID::IDType>::max(),0.);
 	CurveID fixed_curve = -1;
 
@@ -279,27 +349,27 @@ struct CInterval
 	  }
 	}
 
-	CInterval(CPoint begin, CPoint end, CPoint fixed, CurveID fixed_curve)
+	BasicCInterval(CPoint begin, CPoint end, CPoint fixed, CurveID fixed_curve)
 		: begin(begin), end(end), fixed(fixed), fixed_curve(fixed_curve) {}
 #endif
 
-	CInterval()
+	BasicCInterval()
 		: begin(std::numeric_limits<PointID::IDType>::max(), 0.),
 		  end(std::numeric_limits<PointID::IDType>::lowest(), 0.) {}
 
-	CInterval(CInterval const& other) = default;
+	BasicCInterval(BasicCInterval const& other) = default;
 
-	CInterval(CPoint const& begin, CPoint const& end)
+	BasicCInterval(CPoint const& begin, CPoint const& end)
                 : begin(begin), end(end) {}
 
-	CInterval(PointID point1, distance_t fraction1, PointID point2, distance_t fraction2)
+	BasicCInterval(PointID point1, distance_t fraction1, PointID point2, distance_t fraction2)
 		: begin(point1, fraction1), end(point2, fraction2) {}
 
-	CInterval(PointID begin, PointID end)
+	BasicCInterval(PointID begin, PointID end)
 		: begin(begin, 0.), end(end, 0.) {}
 
 	
-	bool operator<(CInterval const& other) const {
+	bool operator<(BasicCInterval const& other) const {
 		return begin < other.begin || (begin == other.begin && end < other.end);
 	}
 
@@ -313,13 +383,20 @@ struct CInterval
 		end = std::min(max, end);
 	}
 };
+using CInterval = BasicCInterval<distance_t>;
 
-std::ostream& operator<<(std::ostream& out, const CInterval& interval);
+template <typename T>
+std::ostream& operator<<(std::ostream& out, const BasicCInterval<T>& interval);
 
-class IntersectionAlgorithm
+template <typename T>
+class BasicIntersectionAlgorithm
 {
 public:
-	static constexpr distance_t eps = 1e-8;
+	using distance_t = T;
+	using Point = BasicPoint<T>;
+	using Interval = BasicInterval<T>;
+
+	static constexpr distance_t eps = ScalarTraits<T>::intersection_eps;
 	
    /*
     * Returns which section of the line segment from line_start to line_end is inside the circle given by circle_center and radius.
@@ -331,8 +408,16 @@ public:
 	* If y = 1 then y' = 1+eps, while if y < 1 then the distance at y' is more than the radius.
     */
 	static Interval intersection_interval(Point circle_center, distance_t radius, Point line_start, Point line_end, Interval * outer = nullptr);
+
+   /*
+    * Batch version of intersection_interval for one circle and the consecutive segments of a chain, i.e., for all 0 <= k < count,
+    * intervals[k] (and outers[k] if outers is not nullptr) is set to the result of intersection_interval(circle_center, radius, points[k], points[k+1]).
+	* The results are exactly the same as the ones of single calls. For double, most segments are processed in SIMD lanes (SSE2, AVX or
+	* AVX-512, depending on the CPU); segments which need the binary search of intersection_interval are handed to the scalar version.
+    */
+	static void intersection_intervals(Point circle_center, distance_t radius, Point const* points, std::size_t count, Interval* intervals, Interval* outers = nullptr);
 private:
-	IntersectionAlgorithm() {} // Make class static-only
+	BasicIntersectionAlgorithm() {} // Make class static-only
 	static inline bool smallDistanceAt(distance_t interpolate, Point line_start, Point line_end, Point circle_center, distance_t radius_sqr);
 	static inline distance_t distanceAt(distance_t interpolate, Point line_start, Point line_end, Point circle_center);
 
@@ -340,6 +425,33 @@ private:
 	static constexpr distance_t save_eps_half = 0.25 * eps;
 };
 
+template <typename T>
+constexpr T BasicIntersectionAlgorithm<T>::eps;
+template <typename T>
+constexpr T BasicIntersectionAlgorithm<T>::save_eps;
+template <typename T>
+constexpr T BasicIntersectionAlgorithm<T>::save_eps_half;
+
+// uses the SIMD kernels of geometry_simd.h
+template <>
+void BasicIntersectionAlgorithm<double>::intersection_intervals(Point circle_center, distance_t radius, Point const* points, std::size_t count, Interval* intervals, Interval* outers);
+
+using IntersectionAlgorithm = BasicIntersectionAlgorithm<distance_t>;
+
+// Critical values, i.e., the distances at which the free-space diagram changes
+// its structure (see Alt and Godau).
+
+// Returns the distance of the point to the segment from line_start to line_end.
+template <typename T>
+T segmentDistance(BasicPoint<T> const& point, BasicPoint<T> const& line_start, BasicPoint<T> const& line_end);
+
+// If the bisector of point1 and point2 intersects the segment from line_start
+// to line_end, sets distance to the distance of the intersection to the points
+// and returns true.
+template <typename T>
+bool bisectorDistance(BasicPoint<T> const& point1, BasicPoint<T> const& point2,
+	BasicPoint<T> const& line_start, BasicPoint<T> const& line_end, T& distance);
+
 // Ellipse
 struct Ellipse
 {
@@ -0,0 +1,72 @@
+#include "geometry_simd.h"
+
+simd::IntersectionKernel simd::getIntersectionKernel()
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) { return intersectionIntervalsAVX512; }
+	if (__builtin_cpu_supports("avx")) { return intersectionIntervalsAVX; }
+#endif
+#if defined(__SSE2__)
+	return intersectionIntervalsSSE2;
+#else
+	return nullptr;
+#endif
+}
+
+#if defined(__SSE2__)
+
+#include <emmintrin.h>
+
+#include "geometry_simd_kernel.h"
+
+namespace
+{
+
+struct SSE2Ops
+{
+	using Vec = __m128d;
+	using Mask = __m128d;
+	static constexpr std::size_t width = 2;
+
+	static Vec set1(double d) { return _mm_set1_pd(d); }
+	static Vec loadu(double const* p) { return _mm_loadu_pd(p); }
+	static void storeu(double* p, Vec a) { _mm_storeu_pd(p, a); }
+
+	static Vec add(Vec a, Vec b) { return _mm_add_pd(a, b); }
+	static Vec sub(Vec a, Vec b) { return _mm_sub_pd(a, b); }
+	static Vec mul(Vec a, Vec b) { return _mm_mul_pd(a, b); }
+	static Vec div(Vec a, Vec b) { return _mm_div_pd(a, b); }
+	static Vec sqrt(Vec a) { return _mm_sqrt_pd(a); }
+	static Vec neg(Vec a) { return _mm_xor_pd(a, _mm_set1_pd(-0.)); }
+	// _mm_min_pd(a, b) is a < b ? a : b, while std::min(a, b) is b < a ? b : a
+	static Vec stdMin(Vec a, Vec b) { return _mm_min_pd(b, a); }
+	static Vec stdMax(Vec a, Vec b) { return _mm_max_pd(b, a); }
+
+	static Mask le(Vec a, Vec b) { return _mm_cmple_pd(a, b); }
+	static Mask ge(Vec a, Vec b) { return _mm_cmpge_pd(a, b); }
+	static Mask maskAnd(Mask a, Mask b) { return _mm_and_pd(a, b); }
+	static Mask maskOr(Mask a, Mask b) { return _mm_or_pd(a, b); }
+	static Mask maskNot(Mask a) { return _mm_xor_pd(a, _mm_castsi128_pd(_mm_set1_epi32(-1))); }
+	static Vec select(Mask mask, Vec a, Vec b) { return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b)); }
+	static int bits(Mask mask) { return _mm_movemask_pd(mask); }
+};
+
+} // end anonymous namespace
+
+std::size_t simd::intersectionIntervalsSSE2(double cx, double cy, double radius,
+	double const* xy, std::size_t count, double* intervals, double* outers, bool* fallback,
+	double eps, double save_eps_half)
+{
+	return intersectionIntervalsKernel<SSE2Ops>(cx, cy, radius, xy, count, intervals, outers, fallback, eps, save_eps_half);
+}
+
+#else
+
+std::size_t simd::intersectionIntervalsSSE2(double, double, double,
+	double const*, std::size_t, double*, double*, bool*, double, double)
+{
+	return 0;
+}
+
+#endif
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+
+// SIMD kernels for IntersectionAlgorithm::intersection_intervals. Each kernel
+// lives in its own translation unit which is compiled for the corresponding
+// instruction set; IntersectionAlgorithm picks one at runtime.
+//
+// The kernels only use plain doubles, i.e., they do not include
+// geometry_basics.h. This way, no inline function of the rest of the code is
+// compiled with instructions which might not be supported by the CPU.
+namespace simd
+{
+
+// Computes the fast path of IntersectionAlgorithm::intersection_interval for
+// the circle (cx, cy, radius) and the segments (k, k+1) of the chain `xy`,
+// which holds interleaved x and y coordinates. The results are written as
+// interleaved begin and end values to `intervals` and, if not nullptr, to
+// `outers`. Lanes for which the fast path does not apply are marked in
+// `fallback`. Returns the number of processed segments, which is `count` for
+// all kernels but the ones of platforms without SIMD support.
+using IntersectionKernel = std::size_t (*)(double cx, double cy, double radius,
+	double const* xy, std::size_t count, double* intervals, double* outers, bool* fallback,
+	double eps, double save_eps_half);
+
+std::size_t intersectionIntervalsSSE2(double cx, double cy, double radius,
+	double const* xy, std::size_t count, double* intervals, double* outers, bool* fallback,
+	double eps, double save_eps_half);
+std::size_t intersectionIntervalsAVX(double cx, double cy, double radius,
+	double const* xy, std::size_t count, double* intervals, double* outers, bool* fallback,
+	double eps, double save_eps_half);
+std::size_t intersectionIntervalsAVX512(double cx, double cy, double radius,
+	double const* xy, std::size_t count, double* intervals, double* outers, bool* fallback,
+	double eps, double save_eps_half);
+
+// Returns the best kernel for the CPU we are running on or nullptr if there is
+// none for this platform.
+IntersectionKernel getIntersectionKernel();
+
+} // end simd
@@ -0,0 +1,62 @@
+#include "geometry_simd.h"
+
+// This file is compiled with -mavx (see CMakeLists.txt) and only called if the
+// CPU supports AVX.
+#if defined(__AVX__)
+
+#include <immintrin.h>
+
+#include "geometry_simd_kernel.h"
+
+namespace
+{
+
+struct AVXOps
+{
+	using Vec = __m256d;
+	using Mask = __m256d;
+	static constexpr std::size_t width = 4;
+
+	static Vec set1(double d) { return _mm256_set1_pd(d); }
+	static Vec loadu(double const* p) { return _mm256_loadu_pd(p); }
+	static void storeu(double* p, Vec a) { _mm256_storeu_pd(p, a); }
+
+	static Vec add(Vec a, Vec b) { return _mm256_add_pd(a, b); }
+	static Vec sub(Vec a, Vec b) { return _mm256_sub_pd(a, b); }
+	static Vec mul(Vec a, Vec b) { return _mm256_mul_pd(a, b); }
+	static Vec div(Vec a, Vec b) { return _mm256_div_pd(a, b); }
+	static Vec sqrt(Vec a) { return _mm256_sqrt_pd(a); }
+	static Vec neg(Vec a) { return _mm256_xor_pd(a, _mm256_set1_pd(-0.)); }
+	// _mm256_min_pd(a, b) is a < b ? a : b, while std::min(a, b) is b < a ? b : a
+	static Vec stdMin(Vec a, Vec b) { return _mm256_min_pd(b, a); }
+	static Vec stdMax(Vec a, Vec b) { return _mm256_max_pd(b, a); }
+
+	static Mask le(Vec a, Vec b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+	static Mask ge(Vec a, Vec b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+	static Mask maskAnd(Mask a, Mask b) { return _mm256_and_pd(a, b); }
+	static Mask maskOr(Mask a, Mask b) { return _mm256_or_pd(a, b); }
+	static Mask maskNot(Mask a) { return _mm256_xor_pd(a, _mm256_castsi256_pd(_mm256_set1_epi32(-1))); }
+	static Vec select(Mask mask, Vec a, Vec b) { return _mm256_blendv_pd(b, a, mask); }
+	static int bits(Mask mask) { return _mm256_movemask_pd(mask); }
+};
+
+} // end anonymous namespace
+
+std::size_t simd::intersectionIntervalsAVX(double cx, double cy, double radius,
+	double const* xy, std::size_t count, double* intervals, double* outers, bool* fallback,
+	double eps, double save_eps_half)
+{
+	return intersectionIntervalsKernel<AVXOps>(cx, cy, radius, xy, count, intervals, outers, fallback, eps, save_eps_half);
+}
+
+#else
+
+// compiled without the target flags, so use the baseline kernel
+std::size_t simd::intersectionIntervalsAVX(double cx, double cy, double radius,
+	double const* xy, std::size_t count, double* intervals, double* outers, bool* fallback,
+	double eps, double save_eps_half)
+{
+	return intersectionIntervalsSSE2(cx, cy, radius, xy, count, intervals, outers, fallback, eps, save_eps_half);
+}
+
+#endif
@@ -0,0 +1,65 @@
+#include "geometry_simd.h"
+
+// This file is compiled with -mavx512f (see CMakeLists.txt) and only called if
+// the CPU supports AVX-512F.
+#if defined(__AVX512F__)
+
+#include <immintrin.h>
+
+#include "geometry_simd_kernel.h"
+
+namespace
+{
+
+struct AVX512Ops
+{
+	using Vec = __m512d;
+	using Mask = __mmask8;
+	static constexpr std::size_t width = 8;
+
+	static Vec set1(double d) { return _mm512_set1_pd(d); }
+	static Vec loadu(double const* p) { return _mm512_loadu_pd(p); }
+	static void storeu(double* p, Vec a) { _mm512_storeu_pd(p, a); }
+
+	static Vec add(Vec a, Vec b) { return _mm512_add_pd(a, b); }
+	static Vec sub(Vec a, Vec b) { return _mm512_sub_pd(a, b); }
+	static Vec mul(Vec a, Vec b) { return _mm512_mul_pd(a, b); }
+	static Vec div(Vec a, Vec b) { return _mm512_div_pd(a, b); }
+	// The unmasked sqrt, min, and max start from an undefined vector, which
+	// makes some GCC versions warn. With a full mask they are the same.
+	static Vec sqrt(Vec a) { return _mm512_mask_sqrt_pd(a, 0xFF, a); }
+	static Vec neg(Vec a) { return _mm512_castsi512_pd(_mm512_xor_epi64(
+		_mm512_castpd_si512(a), _mm512_castpd_si512(_mm512_set1_pd(-0.)))); }
+	// _mm512_min_pd(a, b) is a < b ? a : b, while std::min(a, b) is b < a ? b : a
+	static Vec stdMin(Vec a, Vec b) { return _mm512_mask_min_pd(b, 0xFF, b, a); }
+	static Vec stdMax(Vec a, Vec b) { return _mm512_mask_max_pd(b, 0xFF, b, a); }
+
+	static Mask le(Vec a, Vec b) { return _mm512_cmp_pd_mask(a, b, _CMP_LE_OQ); }
+	static Mask ge(Vec a, Vec b) { return _mm512_cmp_pd_mask(a, b, _CMP_GE_OQ); }
+	static Mask maskAnd(Mask a, Mask b) { return a & b; }
+	static Mask maskOr(Mask a, Mask b) { return a | b; }
+	static Mask maskNot(Mask a) { return ~a; }
+	static Vec select(Mask mask, Vec a, Vec b) { return _mm512_mask_blend_pd(mask, b, a); }
+	static int bits(Mask mask) { return mask; }
+};
+
+} // end anonymous namespace
+
+std::size_t simd::intersectionIntervalsAVX512(double cx, double cy, double radius,
+	double const* xy, std::size_t count, double* intervals, double* outers, bool* fallback,
+	double eps, double save_eps_half)
+{
+	return intersectionIntervalsKernel<AVX512Ops>(cx, cy, radius, xy, count, intervals, outers, fallback, eps, save_eps_half);
+}
+
+#else
+
+// compiled without the target flags, so use the baseline kernel
+std::size_t simd::intersectionIntervalsAVX512(double cx, double cy, double radius,
+	double const* xy, std::size_t count, double* intervals, double* outers, bool* fallback,
+	double eps, double save_eps_half)
+{
+	return intersectionIntervalsSSE2(cx, cy, radius, xy, count, intervals, outers, fallback, eps, save_eps_half);
+}
+
+#endif
@@ -0,0 +1,149 @@
+#pragma once
+
+// Only to be included by geometry_simd*.cpp. The kernel is written
+// against an Ops struct which wraps the intrinsics of one instruction set.
+// Everything is in an anonymous namespace, as each translation unit is compiled
+// with different target flags.
+
+#include <cstddef>
+
+namespace
+{
+
+// Ops has to provide the types Vec and Mask, the vector width, and:
+//   set1, loadu, storeu, add, sub, mul, div, sqrt, neg,
+//   stdMin(a, b) and stdMax(a, b) with the semantics of std::min and std::max,
+//   le, ge (ordered comparisons), maskAnd, maskOr, maskNot,
+//   select(mask, a, b) which is a where mask is set and b otherwise,
+//   bits(mask) which returns the mask as integer with lane i in bit i.
+//
+// The operations are done in exactly the same order as in
+// IntersectionAlgorithm::intersection_interval, so the results are the same
+// as the ones of the scalar version.
+template <typename Ops>
+std::size_t intersectionIntervalsKernel(double cx, double cy, double radius,
+	double const* xy, std::size_t count, double* intervals, double* outers, bool* fallback,
+	double eps, double save_eps_half)
+{
+	using Vec = typename Ops::Vec;
+	using Mask = typename Ops::Mask;
+	constexpr std::size_t width = Ops::width;
+
+	Vec const zero = Ops::set1(0.);
+	Vec const one = Ops::set1(1.);
+	Vec const center_x = Ops::set1(cx);
+	Vec const center_y = Ops::set1(cy);
+	Vec const rad_sqr = Ops::set1(radius * radius);
+	Vec const seh = Ops::set1(save_eps_half);
+
+	std::size_t done = 0;
+	for (; done < count; done += width) {
+		// the lanes after the last segment repeat the last point
+		std::size_t lanes = count - done < width ? count - done : width;
+		double xs[width+1], ys[width+1];
+		for (std::size_t k = 0; k <= width; ++k) {
+			std::size_t i = done + (k < lanes ? k : lanes);
+			xs[k] = xy[2*i];
+			ys[k] = xy[2*i + 1];
+		}
+		Vec const start_x = Ops::loadu(xs);
+		Vec const start_y = Ops::loadu(ys);
+		Vec const end_x = Ops::loadu(xs + 1);
+		Vec const end_y = Ops::loadu(ys + 1);
+
+		auto smallDistanceAt = [&](Vec interpolate) {
+			Vec const one_minus = Ops::sub(one, interpolate);
+			Vec const x = Ops::add(Ops::mul(one_minus, start_x), Ops::mul(interpolate, end_x));
+			Vec const y = Ops::add(Ops::mul(one_minus, start_y), Ops::mul(interpolate, end_y));
+			Vec const dx = Ops::sub(center_x, x);
+			Vec const dy = Ops::sub(center_y, y);
+			return Ops::le(Ops::add(Ops::mul(dx, dx), Ops::mul(dy, dy)), rad_sqr);
+		};
+
+		Vec const v_x = Ops::sub(end_x, start_x);
+		Vec const v_y = Ops::sub(end_y, start_y);
+		Vec const diff_x = Ops::sub(start_x, center_x);
+		Vec const diff_y = Ops::sub(start_y, center_y);
+
+		Vec const a = Ops::add(Ops::mul(v_x, v_x), Ops::mul(v_y, v_y));
+		Vec const b = Ops::add(Ops::mul(diff_x, v_x), Ops::mul(diff_y, v_y));
+		Vec const c = Ops::sub(Ops::add(Ops::mul(diff_x, diff_x), Ops::mul(diff_y, diff_y)), rad_sqr);
+
+		Vec mid = Ops::div(Ops::neg(b), a);
+		Vec const discriminant = Ops::sub(Ops::mul(mid, mid), Ops::div(c, a));
+
+		Mask const small_at_zero = smallDistanceAt(zero);
+		Mask const small_at_one = smallDistanceAt(one);
+		Mask small_at_mid = smallDistanceAt(mid);
+
+		Mask const full = Ops::maskAnd(small_at_zero, small_at_one);
+
+		// move mid to an end point which is close
+		Mask const use_zero = Ops::maskAnd(Ops::maskNot(small_at_mid), small_at_zero);
+		Mask const use_one = Ops::maskAnd(Ops::maskNot(small_at_mid),
+			Ops::maskAnd(Ops::maskNot(small_at_zero), small_at_one));
+		mid = Ops::select(use_zero, zero, Ops::select(use_one, one, mid));
+		small_at_mid = Ops::maskOr(small_at_mid, Ops::maskOr(use_zero, use_one));
+
+		Mask const empty = Ops::maskOr(Ops::maskNot(small_at_mid), Ops::maskOr(
+			Ops::maskAnd(Ops::le(mid, zero), Ops::maskNot(small_at_zero)),
+			Ops::maskAnd(Ops::ge(mid, one), Ops::maskNot(small_at_one))));
+
+		Vec const sqrt_discr = Ops::sqrt(Ops::stdMax(discriminant, zero));
+
+		Vec const lambda1 = Ops::sub(mid, sqrt_discr);
+		Vec const innershift1 = Ops::stdMin(Ops::add(lambda1, seh), Ops::stdMin(one, mid));
+		Vec const outershift1 = Ops::sub(lambda1, seh);
+		Mask const shift1_ok = Ops::maskAnd(Ops::ge(innershift1, outershift1),
+			Ops::maskAnd(smallDistanceAt(innershift1), Ops::maskNot(smallDistanceAt(outershift1))));
+
+		Vec const lambda2 = Ops::add(mid, sqrt_discr);
+		Vec const innershift2 = Ops::stdMax(Ops::sub(lambda2, seh), Ops::stdMax(zero, mid));
+		Vec const outershift2 = Ops::add(lambda2, seh);
+		Mask const shift2_ok = Ops::maskAnd(Ops::le(innershift2, outershift2),
+			Ops::maskAnd(smallDistanceAt(innershift2), Ops::maskNot(smallDistanceAt(outershift2))));
+
+		// the scalar version does a binary search if the shifts do not work
+		Mask const needs_fallback = Ops::maskAnd(Ops::maskNot(Ops::maskOr(full, empty)), Ops::maskOr(
+			Ops::maskAnd(Ops::maskNot(small_at_zero), Ops::maskNot(shift1_ok)),
+			Ops::maskAnd(Ops::maskNot(small_at_one), Ops::maskNot(shift2_ok))));
+
+		Vec const begin = Ops::select(full, zero, Ops::select(empty, one,
+			Ops::select(small_at_zero, zero, innershift1)));
+		Vec const end = Ops::select(full, one, Ops::select(empty, zero,
+			Ops::select(small_at_one, one, innershift2)));
+
+		double begins[width], ends[width];
+		Ops::storeu(begins, begin);
+		Ops::storeu(ends, end);
+		for (std::size_t k = 0; k < lanes; ++k) {
+			intervals[2*(done + k)] = begins[k];
+			intervals[2*(done + k) + 1] = ends[k];
+		}
+
+		if (outers != nullptr) {
+			Vec const minus_eps = Ops::set1(-eps);
+			Vec const one_plus_eps = Ops::set1(1. + eps);
+			Vec const outer_begin = Ops::select(full, minus_eps, Ops::select(empty, one,
+				Ops::select(small_at_zero, minus_eps, outershift1)));
+			Vec const outer_end = Ops::select(full, one_plus_eps, Ops::select(empty, zero,
+				Ops::select(small_at_one, one_plus_eps, outershift2)));
+
+			Ops::storeu(begins, outer_begin);
+			Ops::storeu(ends, outer_end);
+			for (std::size_t k = 0; k < lanes; ++k) {
+				outers[2*(done + k)] = begins[k];
+				outers[2*(done + k) + 1] = ends[k];
+			}
+		}
+
+		auto const fallback_bits = Ops::bits(needs_fallback);
+		for (std::size_t k = 0; k < lanes; ++k) {
+			fallback[done + k] = (fallback_bits >> k) & 1;
+		}
+	}
+
+	return count;
+}
+
+} // end anonymous namespace
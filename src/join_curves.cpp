@@ -0,0 +1,60 @@
+#include "defs.h"
+#include "query.h"
+#include "similarity_join.h"
+
+#include <chrono>
+#include <fstream>
+#include <string>
+
+void printUsage()
+{
+	std::cout <<
+		"Usage: ./join_curves <curve_directory> <curve_data_file1> <curve_data_file2> <distance> <out_file>\n"
+		"\n"
+		"Writes all pairs of a curve of the first and a curve of the second data\n"
+		"set with Fréchet distance at most <distance> to <out_file>, one pair of\n"
+		"filenames per line. If both curve data files are the same, every pair\n"
+		"of different curves is written once.\n"
+		"\n";
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc != 6) {
+		printUsage();
+		ERROR("Wrong number of arguments passed.");
+	}
+
+	std::string curve_directory(argv[1]);
+	std::string curve_data_file1(argv[2]);
+	std::string curve_data_file2(argv[3]);
+	distance_t distance = std::stod(argv[4]);
+	std::string out_file(argv[5]);
+
+	bool const is_self_join = (curve_data_file1 == curve_data_file2);
+	Query query1(curve_directory);
+	Query query2(curve_directory);
+	query1.readCurveData(curve_data_file1);
+	if (!is_self_join) {
+		query2.readCurveData(curve_data_file2);
+	}
+	auto const& curves1 = query1.getCurves();
+	auto const& curves2 = (is_self_join ? query1 : query2).getCurves();
+
+	std::ofstream file(out_file);
+	if (!file.is_open()) {
+		ERROR("The output file could not be opened: " << out_file);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	SimilarityJoin join(curves1, curves2);
+	join.run(distance, [&](CurveID id1, CurveID id2) {
+		file << curves1[id1].filename << " " << curves2[id2].filename << "\n";
+	});
+
+	std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+	std::cout << "Candidates: " << join.getNumberOfCandidates() << "\n";
+	std::cout << "Pairs: " << join.getNumberOfPairs() << "\n";
+	std::cout << "Time: " << time.count() << " s\n";
+}
@@ -4,26 +4,72 @@
 
 #include <algorithm>
 #include <array>
-#include <functional>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <queue>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
-template <typename T, int k, typename V, typename D = T>
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+// A kd-tree whose leaves are buckets of up to bucket_size points. The
+// coordinates of a bucket are stored as structure of arrays, such that a
+// whole bucket is checked against the query point by a few loops over
+// contiguous arrays, which the compiler vectorizes.
+//
+// The points have k coordinates, but the tree only uses and stores the first
+// 'dimension' ones, which is given at construction. So a tree of points with
+// fewer used coordinates than k, e.g., fewer pivots, needs less memory.
+//
+// 'Near' is a functor which checks a bucket:
+//
+//   void operator()(T const* coordinates, std::size_t dimension,
+//       Point const& point, Distance distance, Mask& near) const;
+//
+// sets near[i] iff the i-th point of the bucket is near 'point', where
+// coordinate d of the i-th point is coordinates[d*bucket_size + i]. The
+// unused slots of a bucket have infinite coordinates. As the search prunes
+// the subtrees by their split coordinates, a near point must not differ by
+// more than 'distance' from 'point' in any coordinate. For searchNearest, it
+// also gives the lower bound of the i-th point of a bucket:
+//
+//   Distance lowerBound(T const* coordinates, std::size_t dimension,
+//       std::size_t i, Point const& point) const;
+//
+// which is the smallest distance for which the point is near 'point', and so
+// at least the largest difference of the coordinates.
+template <typename T, int k, typename V, typename Near, typename D = T>
 class KdTree
 {
 	static_assert(k > 0, "Template parameter k should be > 0.");
 	static_assert(std::is_pod<V>::value, "The value parameter should be a POD type.");
 
 public:
+	static constexpr std::size_t bucket_size = 16;
+
 	using Point = std::array<T, k>;
 	using Value = V;
 	using Values = std::vector<Value>;
 	using Distance = D;
-	using NearChecker = std::function<bool(Point const&, Point const&, Distance distance)>;
+	using Mask = std::array<bool, bucket_size>;
+
+	explicit KdTree(std::size_t dimension = k, Near const& near = Near())
+		: dimension(dimension), is_near(near)
+	{
+		assert(dimension > 0 && dimension <= k);
+	}
+
+	// a tree may be a view of a snapshot, see read, so it is only moved
+	KdTree(KdTree const&) = delete;
+	KdTree& operator=(KdTree const&) = delete;
+	KdTree(KdTree&&) = default;
+	KdTree& operator=(KdTree&&) = default;
 
-	KdTree(NearChecker const& near_checker)
-		: is_near(near_checker) {}
+	std::size_t getDimension() const { return dimension; }
 
 	void add(Point const& point, Value value);
 	void build();
@@ -33,141 +79,206 @@ public:
 	// which are <= 'distance' away from 'point'
 	void search(Point const& point, Distance distance, Values& result) const;
 
-protected:
+	// Visits the points in the order of increasing lower bound on their
+	// distance to 'point', which is given by Near::lowerBound. 'visit' gets
+	// the value and the lower bound of a point and returns the distance up to
+	// which the search has to continue, e.g., the distance of the k-th nearest
+	// neighbor found so far. Points with a larger lower bound are not visited.
+	template <typename Visit>
+	void searchNearest(Point const& point, Visit visit) const;
+
+	// Write the built tree with a snapshot::Writer and read it back with a
+	// snapshot::Reader. Only the nodes and buckets are stored, so a tree
+	// which was read can be searched, but no points can be added to it. The
+	// tree which was read uses the arrays in the mapped file, so the reader
+	// has to outlive it. An inconsistent file is an error, as is a value which
+	// is not smaller than value_bound, e.g., the number of curves.
+	template <typename Writer>
+	void write(Writer& writer) const;
+	template <typename Reader>
+	void read(Reader& reader, Value const& value_bound);
+
+private:
+	// the depth of the tree is at most log2 of the number of points, so this
+	// is enough for the stack of the search
+	static constexpr std::size_t max_depth = 64;
+	// the smallest subtrees whose children are built in parallel
+	static constexpr std::size_t parallel_build_size = 1 << 14;
+
+	using NodeID = std::size_t;
+	using PointValue = std::pair<Point, Value>;
+	using PointIterator = typename std::vector<PointValue>::iterator;
+
+	std::size_t dimension;
+	Near is_near;
 	bool is_ready_for_search = false;
-	NearChecker is_near;
 
-	// types: empty = -1, split = 0..k-1, leaf = k
-	// The split value gives the dimension which is used for the split
-	using Type = int;
-	using KdID = std::size_t;
-	struct KdNode
+	// the added points, which are reordered by the build
+	std::vector<PointValue> points;
+
+	// The tree as structure of arrays, the root is the first node. Node id
+	// splits at node_splits[id] in dimension node_dimensions[id], which is -1
+	// for a leaf. The points of the first child have coordinates <= split in
+	// the split dimension, the ones of the second child >= split.
+	// node_indices[id] is the first child (the second one is next to it), or
+	// the bucket of a leaf. Bucket b has the coordinates from
+	// b*dimension*bucket_size on, and the values from b*bucket_size on.
+	std::vector<int> node_dimensions;
+	std::vector<T> node_splits;
+	std::vector<std::size_t> node_indices;
+	std::vector<T> bucket_coordinates;
+	std::vector<Value> bucket_values;
+	std::vector<std::size_t> bucket_sizes;
+
+	// the arrays which are searched: the vectors above after build, or the
+	// arrays in the mapped file after read
+	struct View
 	{
-		KdID id = std::numeric_limits<KdID>::max();
-		Type type = -1;
-		Point point;
-		Value value;
-#ifdef CERTIFY
-		//maintain deletion information for orthogonal range search
-		enum class DeleteState { Present, MarkedDeleted, Deleted };
-		DeleteState delete_flag = DeleteState::Present;
-		bool is_deleted() { return delete_flag == DeleteState::Deleted; }
-		bool holds_value() { return delete_flag == DeleteState::Present; }
-#endif
-
-		KdNode() = default;
-		KdNode(Point const& point, Value value)
-			: point(point), value(value) {}
-
-		bool is_empty() const { return type == -1; }
-		bool is_inner() const { return type >= 0 && type < k; }
-		bool is_leaf() const { return type == k; }
+		int const* node_dimensions = nullptr;
+		T const* node_splits = nullptr;
+		std::size_t const* node_indices = nullptr;
+		T const* bucket_coordinates = nullptr;
+		Value const* bucket_values = nullptr;
+		std::size_t const* bucket_sizes = nullptr;
+		std::size_t num_nodes = 0;
 	};
-	using Tree = std::vector<KdNode>;
-
-	Tree tree;
-
-	// helper structs for the building process
-	using TreeIterator = typename Tree::iterator;
-
-	struct BuildElement
-	{
-		KdID id;
-		TreeIterator begin;
-		TreeIterator end;
-
-		// BuildElement() = default;
-		BuildElement(KdID id, TreeIterator begin, TreeIterator end)
-			: id(id), begin(begin), end(end) {}
-	};
-
-	struct Comp
-	{
-		Comp(int dimension) : dimension(dimension) {}
-
-		bool operator()(KdNode const& node1, KdNode const& node2) const
-		{
-			return node1.point[dimension] < node2.point[dimension];
-		};
+	View view;
 
-	private:
-		int dimension;
-	};
+	void updateView();
+	T const* getCoordinates(std::size_t bucket) const {
+		return view.bucket_coordinates + bucket*dimension*bucket_size;
+	}
 
-	int calcSplitDimension(TreeIterator begin, TreeIterator end) const;
+	// the number of buckets of a subtree with size points
+	static std::size_t countBuckets(std::size_t size);
+	void buildSubtree(NodeID id, NodeID first_node, std::size_t first_bucket,
+		PointIterator begin, PointIterator end, std::size_t depth);
+	int calcSplitDimension(PointIterator begin, PointIterator end) const;
+	void fillBucket(std::size_t bucket, PointIterator begin, PointIterator end);
 };
 
-	template <typename T, int k, typename V, typename D>
-void KdTree<T, k, V, D>::add(Point const& point, Value value)
+template <typename T, int k, typename V, typename Near, typename D>
+void KdTree<T, k, V, Near, D>::add(Point const& point, Value value)
 {
-	tree.emplace_back(point, value);
+	points.emplace_back(point, value);
 	is_ready_for_search = false;
 }
 
-	template <typename T, int k, typename V, typename D>
-void KdTree<T, k, V, D>::build()
+template <typename T, int k, typename V, typename Near, typename D>
+void KdTree<T, k, V, Near, D>::build()
 {
-	if (tree.empty()) { return; }
-
-	std::vector<BuildElement> build_stack;
-	build_stack.emplace_back(0, tree.begin(), tree.end());
-
-	// Give the points the correct IDs (which correspond to their
-	// final position in the tree vector)
-	while (!build_stack.empty()) {
-		auto current = build_stack.back();
-		build_stack.pop_back();
+	is_ready_for_search = true;
+	node_dimensions.clear();
+	node_splits.clear();
+	node_indices.clear();
+	bucket_coordinates.clear();
+	bucket_values.clear();
+	bucket_sizes.clear();
+	view = View();
+	if (points.empty()) { return; }
+
+	// the shape of the tree only depends on the number of points, so all
+	// nodes and buckets can be placed before building the subtrees
+	auto const num_buckets = countBuckets(points.size());
+	node_dimensions.resize(2*num_buckets - 1, -1);
+	node_splits.resize(2*num_buckets - 1);
+	node_indices.resize(2*num_buckets - 1);
+	bucket_coordinates.resize(num_buckets*dimension*bucket_size);
+	bucket_values.resize(num_buckets*bucket_size);
+	bucket_sizes.resize(num_buckets);
+
+	// small trees, e.g., those of the dynamic index, do not start a team
+#ifdef WITH_OPENMP
+	#pragma omp parallel if(points.size() >= parallel_build_size)
+	#pragma omp single
+#endif
+	buildSubtree(0, 1, 0, points.begin(), points.end(), 0);
+	updateView();
+}
 
-		// If only a single element remains in the range
-		if (std::distance(current.begin, current.end) == 1) {
-			current.begin->id = current.id;
-			current.begin->type = k;
-			continue;
-		}
+template <typename T, int k, typename V, typename Near, typename D>
+void KdTree<T, k, V, Near, D>::updateView()
+{
+	view.node_dimensions = node_dimensions.data();
+	view.node_splits = node_splits.data();
+	view.node_indices = node_indices.data();
+	view.bucket_coordinates = bucket_coordinates.data();
+	view.bucket_values = bucket_values.data();
+	view.bucket_sizes = bucket_sizes.data();
+	view.num_nodes = node_dimensions.size();
+}
 
-		// Find median
-		auto median = current.begin + std::distance(current.begin, current.end)/2;
-		auto split_dimension = calcSplitDimension(current.begin, current.end);
-		std::nth_element(current.begin, median, current.end, Comp(split_dimension));
+template <typename T, int k, typename V, typename Near, typename D>
+std::size_t KdTree<T, k, V, Near, D>::countBuckets(std::size_t size)
+{
+	if (size <= bucket_size) { return 1; }
+	return countBuckets(size/2) + countBuckets(size - size/2);
+}
 
-		// Settle the median element
-		median->id = current.id;
-		median->type = split_dimension;
+// Builds the subtree of the points from begin to end at node id. The nodes
+// of the subtree below its root are placed from first_node on, the children
+// first, then the nodes below the first child, then those below the second
+// one. The buckets are placed from first_bucket on in the same order.
+template <typename T, int k, typename V, typename Near, typename D>
+void KdTree<T, k, V, Near, D>::buildSubtree(NodeID id, NodeID first_node, std::size_t first_bucket,
+	PointIterator begin, PointIterator end, std::size_t depth)
+{
+	assert(depth < max_depth);
+	auto const size = static_cast<std::size_t>(std::distance(begin, end));
 
-		// Find correct IDs of remainng elments (and check for empty range before push)
-		if (current.begin < median) {
-			build_stack.emplace_back(2*current.id + 1, current.begin, median);
-		}
-		if (median + 1 < current.end) {
-			build_stack.emplace_back(2*current.id + 2, median + 1, current.end);
-		}
+	if (size <= bucket_size) {
+		node_indices[id] = first_bucket;
+		fillBucket(first_bucket, begin, end);
+		return;
 	}
 
-	// Build tree using the IDs
-	// There are 3 steps to this:
-	// 1) sort by ID (because that's the order in which the points will appear in the tree vector)
-	// 2) resize to largest id (as the tree vector has some gaps)
-	// 3) actually place the points at their correct id (starting from the back of the vector)
-
-	// 1)
-	auto sort_by_id = [](KdNode const& node1, KdNode const& node2) {
-		assert(node1.id != node2.id);
-		return node1.id < node2.id;
-	};
-	std::sort(tree.begin(), tree.end(), sort_by_id);
-	// 2)
-	auto number_of_points = tree.size();
-	tree.resize(tree.back().id + 1);
-	// 3)
-	for(int i = number_of_points - 1; i >= 0; --i) {
-		std::swap(tree[i], tree[tree[i].id]);
+	// split at the median of the dimension with the largest spread
+	auto median = begin + size/2;
+	auto split_dimension = calcSplitDimension(begin, end);
+	std::nth_element(begin, median, end,
+		[&](PointValue const& point1, PointValue const& point2) {
+			return point1.first[split_dimension] < point2.first[split_dimension];
+		});
+
+	node_dimensions[id] = split_dimension;
+	node_splits[id] = median->first[split_dimension];
+	node_indices[id] = first_node;
+
+	auto const first_buckets = countBuckets(size/2);
+	NodeID const second_first_node = first_node + 2 + 2*(first_buckets - 1);
+
+	// the subtrees are independent, so the large ones are built in parallel
+	if (size >= parallel_build_size) {
+#ifdef WITH_OPENMP
+		#pragma omp task
+#endif
+		buildSubtree(first_node, first_node + 2, first_bucket, begin, median, depth + 1);
 	}
+	else {
+		buildSubtree(first_node, first_node + 2, first_bucket, begin, median, depth + 1);
+	}
+	buildSubtree(first_node + 1, second_first_node, first_bucket + first_buckets, median, end, depth + 1);
+}
 
-	is_ready_for_search = true;
+template <typename T, int k, typename V, typename Near, typename D>
+void KdTree<T, k, V, Near, D>::fillBucket(std::size_t bucket, PointIterator begin, PointIterator end)
+{
+	auto* coordinates = bucket_coordinates.data() + bucket*dimension*bucket_size;
+	auto* values = bucket_values.data() + bucket*bucket_size;
+	std::fill(coordinates, coordinates + dimension*bucket_size, std::numeric_limits<T>::infinity());
+
+	std::size_t size = 0;
+	for (auto it = begin; it != end; ++it, ++size) {
+		for (std::size_t d = 0; d < dimension; ++d) {
+			coordinates[d*bucket_size + size] = it->first[d];
+		}
+		values[size] = it->second;
+	}
+	bucket_sizes[bucket] = size;
 }
 
-template <typename T, int k, typename V, typename D>
-int KdTree<T, k, V, D>::calcSplitDimension(TreeIterator begin, TreeIterator end) const
+template <typename T, int k, typename V, typename Near, typename D>
+int KdTree<T, k, V, Near, D>::calcSplitDimension(PointIterator begin, PointIterator end) const
 {
 	Point min;
 	Point max;
@@ -175,18 +286,17 @@ int KdTree<T, k, V, D>::calcSplitDimension(TreeIterator begin, TreeIterator end)
 	max.fill(std::numeric_limits<T>::lowest());
 
 	// find min and max
-	auto find_min_max = [&min, &max](KdNode const& node) {
-		for (std::size_t i = 0; i < k; ++i) {
-			min[i] = std::min(min[i], node.point[i]);
-			max[i] = std::max(max[i], node.point[i]);
+	for (auto it = begin; it != end; ++it) {
+		for (std::size_t i = 0; i < dimension; ++i) {
+			min[i] = std::min(min[i], it->first[i]);
+			max[i] = std::max(max[i], it->first[i]);
 		}
-	};
-	std::for_each(begin, end, find_min_max);
+	}
 
 	// find dimension with largest difference
 	T max_difference = -1;
 	int max_dimension = -1;
-	for (int i = 0; i < k; ++i) {
+	for (int i = 0; i < static_cast<int>(dimension); ++i) {
 		if (max[i] - min[i] > max_difference) {
 			max_difference = max[i] - min[i];
 			max_dimension = i;
@@ -197,47 +307,169 @@ int KdTree<T, k, V, D>::calcSplitDimension(TreeIterator begin, TreeIterator end)
 	return max_dimension;
 }
 
-	template <typename T, int k, typename V, typename D>
-void KdTree<T, k, V, D>::clear()
+template <typename T, int k, typename V, typename Near, typename D>
+void KdTree<T, k, V, Near, D>::clear()
 {
-	tree.clear();
+	points.clear();
+	node_dimensions.clear();
+	node_splits.clear();
+	node_indices.clear();
+	bucket_coordinates.clear();
+	bucket_values.clear();
+	bucket_sizes.clear();
+	view = View();
 	is_ready_for_search = false;
 }
 
-template <typename T, int k, typename V, typename D>
-void KdTree<T, k, V, D>::search(Point const& query_point, Distance distance, Values& result) const
+template <typename T, int k, typename V, typename Near, typename D>
+void KdTree<T, k, V, Near, D>::search(Point const& query_point, Distance distance, Values& result) const
 {
 	assert(is_ready_for_search);
+	if (view.num_nodes == 0) { return; }
+
+	// depth-first search; a node pushes at most two children, so the stack
+	// never holds more than one node per level plus one
+	std::array<NodeID, max_depth + 1> stack;
+	std::size_t stack_size = 0;
+	stack[stack_size++] = 0;
+
+	Mask near;
+	while (stack_size > 0) {
+		auto const id = stack[--stack_size];
+		auto const index = view.node_indices[id];
+
+		if (view.node_dimensions[id] == -1) {
+			auto const* values = view.bucket_values + index*bucket_size;
+			is_near(getCoordinates(index), dimension, query_point, distance, near);
+			for (std::size_t i = 0; i < view.bucket_sizes[index]; ++i) {
+				if (near[i]) { result.push_back(values[i]); }
+			}
+			continue;
+		}
+
+		// Search in subtrees; the second child is pushed first such that the
+		// first one is searched first
+		auto query_coord = query_point[view.node_dimensions[id]];
+		auto const split = view.node_splits[id];
+		if (query_coord + distance >= split) {
+			stack[stack_size++] = index + 1;
+		}
+		if (query_coord - distance <= split) {
+			stack[stack_size++] = index;
+		}
+	}
+}
+
+template <typename T, int k, typename V, typename Near, typename D>
+template <typename Visit>
+void KdTree<T, k, V, Near, D>::searchNearest(Point const& query_point, Visit visit) const
+{
+	assert(is_ready_for_search);
+	if (view.num_nodes == 0) { return; }
+
+	// An element is either a node with the lower bound of its subtree, or
+	// a point of a bucket with the lower bound of the point itself.
+	struct Element
+	{
+		Distance lower_bound;
+		std::size_t id;
+		int slot;
 
-	std::queue<KdID> search_queue;
-	search_queue.push(0);
+		bool is_point() const { return slot >= 0; }
+		bool operator<(Element const& other) const { return lower_bound > other.lower_bound; }
+	};
+	std::priority_queue<Element> search_queue;
+	search_queue.push({0, 0, -1});
 
-	while (!search_queue.empty()) {
-		auto current_index = search_queue.front();
-		auto const& kd_point = tree[current_index];
+	auto max_distance = std::numeric_limits<Distance>::max();
+	while (!search_queue.empty() && search_queue.top().lower_bound <= max_distance) {
+		auto const current = search_queue.top();
 		search_queue.pop();
-		if (kd_point.is_empty()) { continue; }
 
-		// Check if this point is in range
-		if (is_near(kd_point.point, query_point, distance)) {
-			result.push_back(kd_point.value);
+		if (current.is_point()) {
+			max_distance = visit(view.bucket_values[current.id*bucket_size + current.slot], current.lower_bound);
+			continue;
 		}
-		if (kd_point.is_leaf()) { continue; }
-
-		// Search in subtrees
-		assert(kd_point.is_inner());
-
-		auto dimension = kd_point.type;
-		auto query_coord = query_point[dimension];
-		auto split_coord = kd_point.point[dimension];
-		// first child
-		if (query_coord - distance <= split_coord) {
-			assert(2*current_index + 1 < tree.size());
-			search_queue.push(2*current_index + 1);
+
+		auto const index = view.node_indices[current.id];
+		if (view.node_dimensions[current.id] == -1) {
+			auto const* coordinates = getCoordinates(index);
+			for (std::size_t i = 0; i < view.bucket_sizes[index]; ++i) {
+				auto const point_bound = std::max<Distance>(current.lower_bound,
+					is_near.lowerBound(coordinates, dimension, i, query_point));
+				search_queue.push({point_bound, index, static_cast<int>(i)});
+			}
+			continue;
 		}
-		// second child (if it exists -- therefore we also have to check)
-		if (2*current_index + 2 < tree.size() && query_coord + distance >= split_coord) {
-			search_queue.push(2*current_index + 2);
+
+		// Search in subtrees; the subtree on the other side of the split gets
+		// the distance to the split as lower bound
+		Distance split_distance = query_point[view.node_dimensions[current.id]] - view.node_splits[current.id];
+		search_queue.push({std::max(current.lower_bound, split_distance), index, -1});
+		search_queue.push({std::max(current.lower_bound, -split_distance), index + 1, -1});
+	}
+}
+
+template <typename T, int k, typename V, typename Near, typename D>
+template <typename Writer>
+void KdTree<T, k, V, Near, D>::write(Writer& writer) const
+{
+	assert(is_ready_for_search);
+
+	writer.writeArray(view.node_dimensions, view.num_nodes);
+	writer.writeArray(view.node_splits, view.num_nodes);
+	writer.writeArray(view.node_indices, view.num_nodes);
+	auto const num_buckets = view.num_nodes == 0 ? 0 : (view.num_nodes + 1)/2;
+	writer.writeArray(view.bucket_coordinates, num_buckets*dimension*bucket_size);
+	writer.writeArray(view.bucket_values, num_buckets*bucket_size);
+	writer.writeArray(view.bucket_sizes, num_buckets);
+}
+
+template <typename T, int k, typename V, typename Near, typename D>
+template <typename Reader>
+void KdTree<T, k, V, Near, D>::read(Reader& reader, Value const& value_bound)
+{
+	clear();
+
+	View read_view;
+	std::size_t num_splits, num_indices, num_coordinates, num_values, num_buckets;
+	read_view.node_dimensions = reader.template readArray<int>(read_view.num_nodes);
+	read_view.node_splits = reader.template readArray<T>(num_splits);
+	read_view.node_indices = reader.template readArray<std::size_t>(num_indices);
+	read_view.bucket_coordinates = reader.template readArray<T>(num_coordinates);
+	read_view.bucket_values = reader.template readArray<Value>(num_values);
+	read_view.bucket_sizes = reader.template readArray<std::size_t>(num_buckets);
+
+	// The search relies on the shape of the tree: the children of a node come
+	// after it, every leaf has a bucket, and the depth fits the stack.
+	auto const num_nodes = read_view.num_nodes;
+	bool is_consistent = num_splits == num_nodes && num_indices == num_nodes &&
+		num_buckets == (num_nodes == 0 ? 0 : (num_nodes + 1)/2) &&
+		num_coordinates == num_buckets*dimension*bucket_size && num_values == num_buckets*bucket_size;
+	std::vector<std::uint8_t> depths(is_consistent ? num_nodes : 0, 0);
+	for (NodeID id = 0; id < depths.size() && is_consistent; ++id) {
+		auto const split_dimension = read_view.node_dimensions[id];
+		auto const index = read_view.node_indices[id];
+		if (split_dimension == -1) {
+			is_consistent = index < num_buckets && read_view.bucket_sizes[index] <= bucket_size;
+			for (std::size_t slot = 0; is_consistent && slot < read_view.bucket_sizes[index]; ++slot) {
+				is_consistent = read_view.bucket_values[index*bucket_size + slot] < value_bound;
+			}
 		}
+		else {
+			is_consistent = split_dimension >= 0 && static_cast<std::size_t>(split_dimension) < dimension &&
+				index > id && index + 1 < num_nodes && depths[id] < max_depth;
+			if (is_consistent) {
+				auto const child_depth = static_cast<std::uint8_t>(depths[id] + 1);
+				depths[index] = std::max(depths[index], child_depth);
+				depths[index + 1] = std::max(depths[index + 1], child_depth);
+			}
+		}
+	}
+	if (!is_consistent) {
+		ERROR("The kd-tree of the snapshot is inconsistent: " << reader.getFilename());
 	}
+
+	view = read_view;
+	is_ready_for_search = true;
 }
@@ -6,16 +6,63 @@
 void printUsage()
 {
 	std::cout <<
-		"Usage: ./frechet <curve_directory> <curve_data_file> <query_curves_file> [<results_file>]\n"
+		"Usage: ./frechet [--float] [--snapshot | --collection] <curve_directory> <curve_data_file> <query_curves_file> [<results_file>]\n"
 		"\n"
 		"The fourth argument is optional. If only three arguments are passed, then\n"
 		"the results are written to results.txt. More information regarding the\n"
 		"format of the curve and query files can be found in README.\n"
+		"\n"
+		"With --float, the coordinates are stored and processed in single\n"
+		"precision, which needs half the memory.\n"
+		"\n"
+		"With --snapshot, <curve_data_file> is a snapshot of the data set, which\n"
+		"was written by ./frechet_snapshot with the same precision. With\n"
+		"--collection, it is a single file with all curves of the data set, see\n"
+		"./create_curve_collection.\n"
 		"\n";
 }
 
+template <typename T>
+void runQuery(std::string const& curve_directory, std::string const& curve_data_file,
+	std::string const& query_curves_file, std::string const& results_file,
+	bool use_snapshot, bool use_collection)
+{
+	// make everything ready for query
+	BasicQuery<T> query(curve_directory);
+	query.readQueryCurves(query_curves_file);
+	query.setAlgorithm("light");
+	if (use_snapshot) {
+		query.readSnapshot(curve_data_file);
+	}
+	else {
+		if (use_collection) {
+			query.readCurveCollection(curve_data_file);
+		}
+		else {
+			query.readCurveData(curve_data_file);
+		}
+		query.getReady();
+	}
+
+	// run and save result
+	query.run();
+	query.saveResults(results_file);
+}
+
 int main(int argc, char* argv[])
 {
+	bool use_float = (argc > 1 && std::string(argv[1]) == "--float");
+	if (use_float) {
+		--argc;
+		++argv;
+	}
+	bool use_snapshot = (argc > 1 && std::string(argv[1]) == "--snapshot");
+	bool use_collection = (argc > 1 && std::string(argv[1]) == "--collection");
+	if (use_snapshot || use_collection) {
+		--argc;
+		++argv;
+	}
+
 	if (argc <= 3 || argc >= 6) {
 		printUsage();
 		ERROR("Wrong number of arguments passed.");
@@ -26,14 +73,10 @@ int main(int argc, char* argv[])
 	std::string query_curves_file(argv[3]);
 	std::string results_file = (argc == 5 ? argv[4] : "results.txt");
 
-	// make everything ready for query
-	Query query(curve_directory);
-	query.readCurveData(curve_data_file);
-	query.readQueryCurves(query_curves_file);
-	query.setAlgorithm("light");
-	query.getReady();
-
-	// run and save result
-	query.run();
-	query.saveResults(results_file);
+	if (use_float) {
+		runQuery<float>(curve_directory, curve_data_file, query_curves_file, results_file, use_snapshot, use_collection);
+	}
+	else {
+		runQuery<double>(curve_directory, curve_data_file, query_curves_file, results_file, use_snapshot, use_collection);
+	}
 }
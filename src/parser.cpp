@@ -2,7 +2,18 @@
 
 #include "defs.h"
 
-#include <sstream>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
 
 namespace parser
 {
@@ -20,27 +31,299 @@ Curve readCurve(std::string filename)
 	return curve;
 }
 
-void readCurve(std::ifstream& curve_file, Curve& curve)
+namespace
+{
+
+// Reads the whole file at once; the parsers work on the buffer.
+std::string readFile(std::ifstream& file)
+{
+	std::string buffer;
+	file.seekg(0, std::ios::end);
+	auto const size = file.tellg();
+	if (size > 0) {
+		buffer.resize(static_cast<std::size_t>(size));
+		file.seekg(0, std::ios::beg);
+		file.read(&buffer[0], size);
+		buffer.resize(static_cast<std::size_t>(file.gcount()));
+	}
+	else {
+		// not seekable, e.g., a pipe
+		file.clear();
+		buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+	return buffer;
+}
+
+} // namespace
+
+template <typename T>
+void readCurve(std::ifstream& curve_file, BasicCurve<T>& curve)
+{
+	std::string buffer = readFile(curve_file);
+	readCurve(buffer.data(), buffer.data() + buffer.size(), curve);
+}
+
+namespace
+{
+
+bool isSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+bool isDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+// Parses the number at the start of [pos, end) and advances pos behind it.
+// Decimal numbers with at most 19 significant digits, whose mantissa and
+// power of ten are exact doubles, are one multiplication or division of
+// exact values, which IEEE arithmetic rounds correctly. All other numbers,
+// e.g., with many digits, hexadecimal ones, or inf and nan, are passed to
+// strtod, so the result is always the same as that of std::stod.
+bool parseDouble(char const*& pos, char const* end, double& value)
+{
+	static double const powers_of_ten[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	std::uint64_t const max_exact_mantissa = std::uint64_t(1) << 53;
+
+	char const* p = pos;
+	bool negative = false;
+	if (p != end && (*p == '-' || *p == '+')) {
+		negative = (*p == '-');
+		++p;
+	}
+
+	std::uint64_t mantissa = 0;
+	int num_digits = 0;
+	int exponent = 0;
+	bool has_digits = false;
+
+	// leading zeros are not significant
+	while (p != end && *p == '0') { ++p; has_digits = true; }
+	for (; p != end && isDigit(*p); ++p, has_digits = true) {
+		if (num_digits < 19) { mantissa = 10*mantissa + (*p - '0'); ++num_digits; }
+		else { ++exponent; }
+	}
+	if (p != end && *p == '.') {
+		++p;
+		if (num_digits == 0) {
+			for (; p != end && *p == '0'; ++p, has_digits = true) { --exponent; }
+		}
+		for (; p != end && isDigit(*p); ++p, has_digits = true) {
+			if (num_digits < 19) { mantissa = 10*mantissa + (*p - '0'); ++num_digits; --exponent; }
+		}
+	}
+
+	bool is_simple = has_digits;
+	if (has_digits && p != end && (*p == 'e' || *p == 'E')) {
+		char const* q = p + 1;
+		bool negative_exponent = false;
+		if (q != end && (*q == '-' || *q == '+')) {
+			negative_exponent = (*q == '-');
+			++q;
+		}
+		if (q != end && isDigit(*q)) {
+			int explicit_exponent = 0;
+			for (; q != end && isDigit(*q); ++q) {
+				if (explicit_exponent < 10000) { explicit_exponent = 10*explicit_exponent + (*q - '0'); }
+			}
+			exponent += (negative_exponent ? -explicit_exponent : explicit_exponent);
+			p = q;
+		}
+	}
+	// 0x..., inf, nan, and the like
+	if (p != end && !isSpace(*p) && (*p == 'x' || *p == 'X' || !has_digits)) {
+		is_simple = false;
+	}
+	is_simple = is_simple && num_digits < 19 && mantissa <= max_exact_mantissa &&
+		exponent >= -22 && exponent <= 22;
+
+	if (is_simple) {
+		value = static_cast<double>(mantissa);
+		value = (exponent < 0 ? value/powers_of_ten[-exponent] : value*powers_of_ten[exponent]);
+		if (negative) { value = -value; }
+		pos = p;
+		return true;
+	}
+
+	// strtod needs a terminated string; tokens which are longer than that
+	// are not numbers anyway
+	char token[128];
+	std::size_t length = 0;
+	while (pos + length != end && !isSpace(pos[length]) && length < sizeof(token) - 1) {
+		token[length] = pos[length];
+		++length;
+	}
+	token[length] = '\0';
+
+	char* token_end;
+	value = std::strtod(token, &token_end);
+	if (token_end == token) { return false; }
+	pos += token_end - token;
+	return true;
+}
+
+// Reads the next coordinate before end, skipping whitespace; like std::stod,
+// everything after the number in a token is ignored.
+bool readCoordinate(char const*& pos, char const* end, double& value)
 {
-	// Read everything into a stringstream.
-	std::stringstream ss;
-	ss << curve_file.rdbuf();
+	while (pos != end && isSpace(*pos)) { ++pos; }
+	if (pos == end) { return false; }
+	if (!parseDouble(pos, end, value)) {
+		ERROR("Invalid coordinate in curve file: " << std::string(pos, std::find_if(pos, end, isSpace)));
+	}
+	while (pos != end && !isSpace(*pos)) { ++pos; }
+	return true;
+}
+
+template <typename T>
+void addPoint(BasicCurve<T>& curve, double x_value, double y_value)
+{
+	T x = x_value;
+	T y = y_value;
 
-	auto ignore_count = std::numeric_limits<std::streamsize>::max();
+	// ignore duplicate rows
+	if (curve.size() && curve.back().x == x && curve.back().y == y) {
+		return;
+	}
+	curve.push_back({x, y});
+}
 
-	std::string x_str, y_str;
-	while (ss >> x_str >> y_str) {
-		distance_t x, y;
-		x = std::stod(x_str);
-		y = std::stod(y_str);
+} // namespace
 
-		ss.ignore(ignore_count, '\n');
-		// ignore duplicate rows
-		if (curve.size() && curve.back().x == x && curve.back().y == y) {
-			continue;
+template <typename T>
+void readCurve(char const* begin, char const* end, BasicCurve<T>& curve)
+{
+	double x, y;
+	while (readCoordinate(begin, end, x) && readCoordinate(begin, end, y)) {
+		// ignore the rest of the line
+		begin = std::find(begin, end, '\n');
+		addPoint(curve, x, y);
+	}
+}
+
+template <typename T>
+void readCurveCollection(char const* begin, char const* end, BasicCurves<T>& curves)
+{
+	struct Name { char const* begin; std::size_t length; };
+
+	// Find the first line of each curve. This only compares the names, so
+	// it is cheap compared to parsing the coordinates afterwards.
+	std::vector<Name> names;
+	std::vector<char const*> curve_begins;
+	for (char const* line = begin; line != end; ) {
+		auto const* newline = static_cast<char const*>(std::memchr(line, '\n', end - line));
+		char const* line_end = (newline == nullptr ? end : newline);
+
+		char const* name_begin = std::find_if_not(line, line_end, isSpace);
+		if (name_begin != line_end) {
+			// most lines continue the curve of the line before
+			bool const is_same_curve = !names.empty() &&
+				static_cast<std::size_t>(line_end - name_begin) > names.back().length &&
+				std::memcmp(name_begin, names.back().begin, names.back().length) == 0 &&
+				isSpace(name_begin[names.back().length]);
+			if (!is_same_curve) {
+				char const* name_end = std::find_if(name_begin, line_end, isSpace);
+				names.push_back({name_begin, static_cast<std::size_t>(name_end - name_begin)});
+				curve_begins.push_back(line);
+			}
+		}
+		line = (line_end == end ? end : line_end + 1);
+	}
+	curve_begins.push_back(end);
+
+	auto const first_curve = curves.size();
+	curves.resize(first_curve + names.size());
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for schedule(dynamic, 16)
+#endif
+	for (std::size_t i = 0; i < names.size(); ++i) {
+		auto& curve = curves[first_curve + i];
+		curve.filename.assign(names[i].begin, names[i].length);
+
+		char const* pos = curve_begins[i];
+		char const* const curve_end = curve_begins[i + 1];
+		while (true) {
+			// skip the name
+			pos = std::find_if_not(pos, curve_end, isSpace);
+			if (pos == curve_end) { break; }
+			pos += names[i].length;
+
+			double x, y;
+			if (!readCoordinate(pos, curve_end, x) || !readCoordinate(pos, curve_end, y)) {
+				ERROR("A line of curve " << curve.filename << " has less than two coordinates.");
+			}
+			addPoint(curve, x, y);
+
+			// ignore the rest of the line
+			pos = std::find(pos, curve_end, '\n');
 		}
-		curve.push_back({x, y});
 	}
 }
 
+template <typename T>
+void readCurveCollection(std::string const& filename, BasicCurves<T>& curves)
+{
+	std::ifstream file(filename);
+	if (!file.is_open()) {
+		ERROR("Could not open curve collection file " << filename);
+	}
+
+	std::string buffer = readFile(file);
+	readCurveCollection(buffer.data(), buffer.data() + buffer.size(), curves);
+}
+
+template <typename T>
+void writeCurveCollection(std::string const& filename, BasicCurves<T> const& curves)
+{
+	std::ofstream file(filename);
+	if (!file.is_open()) {
+		ERROR("Could not open curve collection file " << filename);
+	}
+
+	// the shortest representation which reads back to the same value, which
+	// is also the one the parser reads fastest
+	auto shortest = [](T value, char* buffer, std::size_t size) {
+		for (int precision = std::numeric_limits<T>::digits10; ; ++precision) {
+			std::snprintf(buffer, size, "%.*g", precision, static_cast<double>(value));
+			if (static_cast<T>(std::strtod(buffer, nullptr)) == value ||
+					precision == std::numeric_limits<T>::max_digits10) {
+				return buffer;
+			}
+		}
+	};
+	char x_buffer[64];
+	char y_buffer[64];
+
+	for (auto const& curve: curves) {
+		if (curve.filename.empty() || std::find_if(curve.filename.begin(), curve.filename.end(), isSpace) != curve.filename.end()) {
+			ERROR("The name of a curve in a collection must not be empty or contain whitespace: '" << curve.filename << "'");
+		}
+		for (auto const& point: curve) {
+			file << curve.filename << " " << shortest(point.x, x_buffer, sizeof(x_buffer))
+				<< " " << shortest(point.y, y_buffer, sizeof(y_buffer)) << "\n";
+		}
+	}
+
+	if (!file) {
+		ERROR("Could not write curve collection file " << filename);
+	}
+}
+
+template void readCurve(std::ifstream& curve_file, BasicCurve<float>& curve);
+template void readCurve(std::ifstream& curve_file, BasicCurve<double>& curve);
+template void readCurve(char const* begin, char const* end, BasicCurve<float>& curve);
+template void readCurve(char const* begin, char const* end, BasicCurve<double>& curve);
+template void readCurveCollection(char const* begin, char const* end, BasicCurves<float>& curves);
+template void readCurveCollection(char const* begin, char const* end, BasicCurves<double>& curves);
+template void readCurveCollection(std::string const& filename, BasicCurves<float>& curves);
+template void readCurveCollection(std::string const& filename, BasicCurves<double>& curves);
+template void writeCurveCollection(std::string const& filename, BasicCurves<float> const& curves);
+template void writeCurveCollection(std::string const& filename, BasicCurves<double> const& curves);
+
 } // namespace parser
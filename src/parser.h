@@ -8,6 +8,23 @@ namespace parser
 {
 
 Curve readCurve(std::string filename);
-void readCurve(std::ifstream& curve_file, Curve& curve);
+template <typename T>
+void readCurve(std::ifstream& curve_file, BasicCurve<T>& curve);
+// Parses the curve in the buffer from begin to end: a point per line with
+// its x and y coordinate, which may be followed by other columns.
+template <typename T>
+void readCurve(char const* begin, char const* end, BasicCurve<T>& curve);
+
+// A curve collection is a single file with all curves of a data set. Each
+// line is a point: the name of its curve, its x and its y coordinate, which
+// may be followed by other columns. The lines of a curve are consecutive, and
+// the names must not contain whitespace. The curves are appended to curves
+// with their names as filenames.
+template <typename T>
+void readCurveCollection(std::string const& filename, BasicCurves<T>& curves);
+template <typename T>
+void readCurveCollection(char const* begin, char const* end, BasicCurves<T>& curves);
+template <typename T>
+void writeCurveCollection(std::string const& filename, BasicCurves<T> const& curves);
 
 } // namespace parser
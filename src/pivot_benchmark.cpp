@@ -0,0 +1,68 @@
+#include "defs.h"
+#include "pivot_table.h"
+#include "query.h"
+
+#include <chrono>
+#include <string>
+
+void printUsage()
+{
+	std::cout <<
+		"Usage: ./pivot_benchmark <curve_directory> <curve_data_file> <pivot_index_file> <query_file>\n"
+		"\n"
+		"Runs the queries once with only the kd-tree and once with the pivot\n"
+		"index of build_pivot_index, and prints the number of candidates and\n"
+		"the query times of both runs.\n"
+		"\n";
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc != 5) {
+		printUsage();
+		ERROR("Wrong number of arguments passed.");
+	}
+
+	std::string curve_directory(argv[1]);
+	std::string curve_data_file(argv[2]);
+	std::string pivot_index_file(argv[3]);
+	std::string query_file(argv[4]);
+
+	PivotTable pivot_table;
+	pivot_table.read(pivot_index_file);
+
+	Query query(curve_directory);
+	query.readCurveData(curve_data_file);
+	query.readQueryCurves(query_file);
+	query.setAlgorithm("light");
+
+	auto run = [&](PivotTable const* table) {
+		query.setPivotTable(table);
+		query.getReady();
+		auto start = std::chrono::steady_clock::now();
+		query.run_parallel();
+		std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+		return time.count();
+	};
+
+	auto const time_kd = run(nullptr);
+	auto const results_kd = query.getResults();
+	auto const time_pivots = run(&pivot_table);
+
+	auto const& results_pivots = query.getResults();
+	for (std::size_t i = 0; i < results_kd.size(); ++i) {
+		if (results_kd[i].curve_ids != results_pivots[i].curve_ids) {
+			ERROR("The results with and without the pivot index differ.");
+		}
+	}
+
+	auto const kd_candidates = query.getNumberOfKdCandidates();
+	auto const pivot_candidates = query.getNumberOfPivotCandidates();
+	std::cout << "Number of pivots: " << pivot_table.getPivots().size() << "\n";
+	std::cout << "Candidates of the kd-tree: " << kd_candidates << "\n";
+	std::cout << "Candidates after the pivots: " << pivot_candidates << " ("
+		<< (kd_candidates == 0 ? 0. : 100.*pivot_candidates/kd_candidates) << " %)\n";
+	std::cout << "Time without pivots: " << time_kd << " s\n";
+	std::cout << "Time with pivots: " << time_pivots << " s\n";
+	std::cout << "Speedup: " << time_kd/time_pivots << "\n";
+}
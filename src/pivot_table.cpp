@@ -0,0 +1,128 @@
+#include "pivot_table.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+template <typename T>
+void BasicPivotTable<T>::build(Curves const& curves, std::size_t num_pivots)
+{
+	num_curves = curves.size();
+	num_pivots = std::min(num_pivots, num_curves);
+	pivots.clear();
+	distances.assign(num_curves*num_pivots, 0.);
+	if (num_pivots == 0) { return; }
+
+	// the distance of each curve to the closest pivot so far
+	std::vector<distance_t> pivot_distances(num_curves, std::numeric_limits<T>::infinity());
+
+	CurveID next_pivot = 0;
+	for (std::size_t p = 0; p < num_pivots; ++p) {
+		pivots.push_back(next_pivot);
+		auto const& pivot_curve = curves[next_pivot];
+
+#ifdef WITH_OPENMP
+		#pragma omp parallel
+#endif
+		{
+			FrechetLight frechet;
+
+#ifdef WITH_OPENMP
+			#pragma omp for schedule(dynamic, 16)
+#endif
+			for (std::size_t id = 0; id < num_curves; ++id) {
+				distance_t distance = (id == next_pivot ? 0. : frechet.calcDistance(pivot_curve, curves[id]));
+				distances[id*num_pivots + p] = distance;
+				pivot_distances[id] = std::min(pivot_distances[id], distance);
+			}
+		}
+
+		// farthest-first; the smallest ID on ties keeps the pivots deterministic
+		next_pivot = std::max_element(pivot_distances.begin(), pivot_distances.end()) - pivot_distances.begin();
+	}
+}
+
+template <typename T>
+void BasicPivotTable<T>::write(std::string const& filename) const
+{
+	std::ofstream file(filename);
+	if (!file.is_open()) {
+		ERROR("The pivot table file could not be opened: " << filename);
+	}
+
+	file << std::setprecision(std::numeric_limits<T>::max_digits10);
+	file << num_curves << " " << pivots.size() << "\n";
+	for (std::size_t p = 0; p < pivots.size(); ++p) {
+		file << (p == 0 ? "" : " ") << pivots[p];
+	}
+	file << "\n";
+	for (CurveID id = 0; id < num_curves; ++id) {
+		for (std::size_t p = 0; p < pivots.size(); ++p) {
+			file << (p == 0 ? "" : " ") << getDistance(id, p);
+		}
+		file << "\n";
+	}
+}
+
+template <typename T>
+void BasicPivotTable<T>::read(std::string const& filename)
+{
+	std::ifstream file(filename);
+	if (!file.is_open()) {
+		ERROR("The pivot table file could not be opened: " << filename);
+	}
+
+	std::size_t num_pivots;
+	if (!(file >> num_curves >> num_pivots)) {
+		ERROR("The pivot table file has an invalid header: " << filename);
+	}
+	pivots.resize(num_pivots);
+	for (auto& pivot: pivots) {
+		file >> pivot;
+	}
+	distances.resize(num_curves*num_pivots);
+	for (auto& distance: distances) {
+		file >> distance;
+	}
+	if (!file) {
+		ERROR("The pivot table file is incomplete: " << filename);
+	}
+}
+
+template <typename T>
+T BasicPivotTable<T>::getDistance(CurveID curve_id, std::size_t pivot_index) const
+{
+	assert(curve_id < num_curves && pivot_index < pivots.size());
+	return distances[curve_id*pivots.size() + pivot_index];
+}
+
+template <typename T>
+void BasicPivotTable<T>::prune(Curve const& curve, Curves const& curves, distance_t distance,
+	FrechetLight& frechet, CurveIDs& candidates) const
+{
+	assert(curves.size() == num_curves);
+
+	for (std::size_t p = 0; p < pivots.size(); ++p) {
+		if (candidates.size() < min_candidates_per_pivot) { break; }
+
+		auto const bounds = frechet.calcDistanceApprox(curve, curves[pivots[p]], query_rel_eps);
+		// the table and the deciders are only exact up to their precision
+		distance_t const slack = FrechetLight::critical_slack*(distance + bounds.end) + 2*FrechetLight::eps;
+
+		auto is_far = [&](CurveID id) {
+			distance_t const pivot_distance = getDistance(id, p);
+			return bounds.begin - pivot_distance > distance + slack ||
+				pivot_distance - bounds.end > distance + slack;
+		};
+		candidates.erase(std::remove_if(candidates.begin(), candidates.end(), is_far), candidates.end());
+	}
+}
+
+template class BasicPivotTable<float>;
+template class BasicPivotTable<double>;
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "defs.h"
+#include "frechet_light.h"
+#include "geometry_basics.h"
+#include "curves.h"
+
+#include <string>
+#include <vector>
+
+// A metric index over a data set: the Fréchet distances of all curves to a
+// few pivot curves of the data set. As the Fréchet distance is a metric,
+// |d(q, p) - d(c, p)| <= d(q, c) for a query curve q, a pivot p and a curve c,
+// so a candidate c can be discarded if this difference is larger than the
+// query distance for some pivot.
+//
+// The pivots are chosen farthest-first: the first curve of the data set, and
+// then always the curve with the largest distance to the pivots so far.
+template <typename T>
+class BasicPivotTable
+{
+public:
+	using distance_t = T;
+	using Curve = BasicCurve<T>;
+	using Curves = BasicCurves<T>;
+	using FrechetLight = BasicFrechetLight<T>;
+
+	// the precision of the distances of a query to the pivots
+	static constexpr distance_t query_rel_eps = 1e-2;
+	// A distance of the query to a pivot needs several decider calls, while
+	// most candidates are decided by the filters. So the next pivot is only
+	// used while there are at least this many candidates left.
+	static constexpr std::size_t min_candidates_per_pivot = 16;
+
+	void build(Curves const& curves, std::size_t num_pivots);
+
+	// File format: the number of curves and the number of pivots, the IDs of
+	// the pivots, and then for each curve the distances to the pivots, each
+	// on one line.
+	void write(std::string const& filename) const;
+	void read(std::string const& filename);
+
+	std::size_t getNumberOfCurves() const { return num_curves; }
+	CurveIDs const& getPivots() const { return pivots; }
+	distance_t getDistance(CurveID curve_id, std::size_t pivot_index) const;
+
+	// Removes the candidates which are farther than distance from the query
+	// curve by the triangle inequality. The distances of the query to the
+	// pivots are only computed as long as enough candidates are left, see
+	// min_candidates_per_pivot.
+	void prune(Curve const& curve, Curves const& curves, distance_t distance,
+		FrechetLight& frechet, CurveIDs& candidates) const;
+
+private:
+	std::size_t num_curves = 0;
+	CurveIDs pivots;
+	// the distances to the pivots, one row per curve
+	std::vector<distance_t> distances;
+};
+
+template <typename T>
+constexpr T BasicPivotTable<T>::query_rel_eps;
+template <typename T>
+constexpr std::size_t BasicPivotTable<T>::min_candidates_per_pivot;
+
+using PivotTable = BasicPivotTable<distance_t>;
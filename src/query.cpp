@@ -5,8 +5,14 @@
 #include "frechet_light.h"
 #include "frechet_naive.h"
 #include "parser.h"
+#include "snapshot.h"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <fstream>
+#include <limits>
+#include <queue>
 #include <sstream>
 #include <vector>
 #include <iomanip>
@@ -15,28 +21,9 @@
 #include <omp.h>
 #endif
 
-namespace
-{
-
-inline static bool isNear(Tree::Point const& a, Tree::Point const& b, distance_t distance)
-{
-	for (size_t i = 0; i < 4; i += 2) {
-		auto d = (a[i] - b[i])*(a[i] - b[i]) + (a[i + 1] - b[i + 1])*(a[i + 1] - b[i + 1]);
-		if (d > distance*distance) { return false; }
-	}
-	for (size_t i = 4; i < 8; ++i) {
-		auto d = std::abs(a[i] - b[i]);
-		if (d > distance) { return false; }
-	}
-
-	return true;
-}
-
-} // end anonymous namespace
-
-Query::Query(std::string const& curve_directory)
+template <typename T>
+BasicQuery<T>::BasicQuery(std::string const& curve_directory)
 	: curve_directory(curve_directory)
-	, kd_tree(isNear)
 #ifdef WITH_OPENMP
 	, num_threads(omp_get_max_threads())
 #else
@@ -44,9 +31,15 @@ Query::Query(std::string const& curve_directory)
 #endif
 	, thread_data_vec(num_threads)
 {
+	// the distance deciders are never called at the same time as the others
+	distance_frechet.setWorkspace(&workspace);
+	for (auto& thread_data: thread_data_vec) {
+		thread_data.distance_frechet.setWorkspace(&thread_data.workspace);
+	}
 }
 
-Query::~Query()
+template <typename T>
+BasicQuery<T>::~BasicQuery()
 {
 	delete frechet;
 	frechet = nullptr;
@@ -57,7 +50,8 @@ Query::~Query()
 	}
 }
 
-void Query::readCurveData(std::string const& curve_data_file)
+template <typename T>
+void BasicQuery<T>::readCurveData(std::string const& curve_data_file)
 {
 	is_ready = false;
 
@@ -74,26 +68,38 @@ void Query::readCurveData(std::string const& curve_data_file)
 		ERROR("The curve data file could not be opened: " << curve_data_file);
 	}
 
-	// read curves
+	// read curves; the files are independent, so they are read in parallel
 	curve_data.clear();
-	curve_data.reserve(curve_filenames.size());
+	curve_arena.clear();
+	snapshot_reader.reset();
+	curve_data.resize(curve_filenames.size());
+	readCurveFiles(curve_filenames, [&](std::size_t i) -> Curve& { return curve_data[i]; });
 
-	for (auto const& curve_filename: curve_filenames) {
-		std::ifstream curve_file(curve_directory + curve_filename);
-		if (curve_file.is_open()) {
-			curve_data.emplace_back();
-			parser::readCurve(curve_file, curve_data.back());
-			curve_data.back().filename = curve_filename;
+	curve_data.erase(std::remove_if(curve_data.begin(), curve_data.end(),
+		[](Curve const& curve) { return curve.empty(); }), curve_data.end());
+}
 
-			if (curve_data.back().empty()) { curve_data.pop_back(); }
-		}
-		else {
-			ERROR("A curve file could not be opened: " << curve_directory + curve_filename);
-		}
-	}
+template <typename T>
+void BasicQuery<T>::readCurveCollection(std::string const& collection_file)
+{
+	is_ready = false;
+	curve_data.clear();
+	curve_arena.clear();
+	snapshot_reader.reset();
+	parser::readCurveCollection(collection_file, curve_data);
 }
 
-void Query::readQueryCurves(std::string const& query_curves_file)
+template <typename T>
+void BasicQuery<T>::setCurveData(Curves&& curves)
+{
+	is_ready = false;
+	curve_data = std::move(curves);
+	curve_arena.clear();
+	snapshot_reader.reset();
+}
+
+template <typename T>
+void BasicQuery<T>::readQueryCurves(std::string const& query_curves_file)
 {
 	query_elements.clear();
 
@@ -116,42 +122,91 @@ void Query::readQueryCurves(std::string const& query_curves_file)
 	}
 
 	// read curves
+	readCurveFiles(curve_filenames, [&](std::size_t i) -> Curve& { return query_elements[i].curve; });
+}
+
+template <typename T>
+template <typename CurveAt>
+void BasicQuery<T>::readCurveFiles(std::vector<std::string> const& curve_filenames, CurveAt curve_at)
+{
+	// the first file which could not be opened, reported after the loop
+	std::size_t failed = curve_filenames.size();
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for schedule(dynamic, 16) num_threads(num_threads)
+#endif
 	for (std::size_t i = 0; i < curve_filenames.size(); ++i) {
 		std::ifstream curve_file(curve_directory + curve_filenames[i]);
 		if (curve_file.is_open()) {
-			parser::readCurve(curve_file, query_elements[i].curve);
-			query_elements[i].curve.filename = curve_filenames[i];
+			Curve& curve = curve_at(i);
+			parser::readCurve(curve_file, curve);
+			curve.filename = curve_filenames[i];
 		}
 		else {
-			ERROR("A curve file could not be opened: " << curve_directory + curve_filenames[i]);
+#ifdef WITH_OPENMP
+			#pragma omp critical(read_curve_files)
+#endif
+			failed = std::min(failed, i);
 		}
 	}
+
+	if (failed != curve_filenames.size()) {
+		ERROR("A curve file could not be opened: " << curve_directory + curve_filenames[failed]);
+	}
 }
 
-void Query::setAlgorithm(std::string const& frechet_version)
+template <typename T>
+void BasicQuery<T>::setAlgorithm(std::string const& frechet_version)
 {
 	delete frechet;
 	frechet = nullptr;
+	for (auto& thread_data: thread_data_vec) {
+		delete thread_data.frechet;
+		thread_data.frechet = nullptr;
+	}
 
 	if (frechet_version == "light") {
-		frechet = new FrechetLight();
+		frechet = new BasicFrechetLight<T>();
 		for (auto& thread_data: thread_data_vec) {
-			thread_data.frechet = new FrechetLight();
+			thread_data.frechet = new BasicFrechetLight<T>();
 		}
 	}
 	else if (frechet_version == "naive") {
-		frechet = new FrechetNaive();
+		frechet = new BasicFrechetNaive<T>();
 		for (auto& thread_data: thread_data_vec) {
-			thread_data.frechet = new FrechetNaive();
+			thread_data.frechet = new BasicFrechetNaive<T>();
 		}
 	}
 	else {
 		ERROR("Unknown Frechet version: " << frechet_version << "\n"
 			  "Known Frechet versions: light, naive");
 	}
+
+	// the deciders reuse the memory of their workspace across all queries
+	frechet->setWorkspace(&workspace);
+	for (auto& thread_data: thread_data_vec) {
+		thread_data.frechet->setWorkspace(&thread_data.workspace);
+	}
 }
 
-void Query::getReady()
+template <typename T>
+void BasicQuery<T>::setPivotTable(BasicPivotTable<T> const* pivot_table)
+{
+	this->pivot_table = pivot_table;
+}
+
+template <typename T>
+void BasicQuery<T>::setNumberOfKdPivots(std::size_t num_pivots)
+{
+	if (num_pivots > kd_max_pivots) {
+		ERROR("At most " << kd_max_pivots << " pivots can be added to the kd-tree.");
+	}
+	num_kd_pivots = num_pivots;
+	is_ready = false;
+}
+
+template <typename T>
+void BasicQuery<T>::getReady()
 {
 	results.clear();
 
@@ -159,18 +214,164 @@ void Query::getReady()
 	// build all the data structures and make queries ready
 	//
 
+	// all points in one block, in the spatial order of the curves
+	curve_arena.pack(curve_data);
+
 	// for sequential
-	kd_tree.clear();
+	kd_pivots = chooseKdPivots(curve_data, num_kd_pivots);
+	global::times.startKdBuild();
+	std::vector<typename Tree::Point> kd_points(curve_data.size());
+#ifdef WITH_OPENMP
+	#pragma omp parallel for schedule(static) num_threads(num_threads)
+#endif
+	for (std::size_t id = 0; id < curve_data.size(); ++id) {
+		kd_points[id] = toKdPoint(curve_data[id], kd_pivots);
+	}
+	kd_tree = Tree(kd_feature_dimension + kd_pivots.size());
 	for (CurveID id = 0; id < curve_data.size(); ++id) {
-		auto const& curve = curve_data[id];
-		kd_tree.add(toKdPoint(curve), id);
+		kd_tree.add(kd_points[id], id);
 	}
 	kd_tree.build();
+	global::times.stopKdBuild();
+	// the curves and the tree do not use a snapshot anymore
+	snapshot_reader.reset();
+	num_kd_candidates = 0;
+	num_pivot_candidates = 0;
+
+	if (pivot_table != nullptr && pivot_table->getNumberOfCurves() != curve_data.size()) {
+		ERROR("The pivot table does not belong to the curve data.");
+	}
 
 	is_ready = true;
 }
 
-void Query::run()
+// The snapshot file contains:
+// - the header: magic bytes, version, size of the coordinates, and the
+//   dimension and bucket size of the kd-tree
+// - the curves: the offset and size of each curve in the arrays of all
+//   points and prefix lengths, these two arrays in the order of the curve
+//   arena, the extreme points of each curve, and the offsets of each filename
+//   in the array of all their characters
+// - the kd-tree: its pivots, its nodes, and its buckets
+namespace
+{
+	char const snapshot_magic[8] = {'F', 'R', 'E', 'C', 'H', 'E', 'T', 'S'};
+}
+
+template <typename T>
+void BasicQuery<T>::writeSnapshot(std::string const& snapshot_file) const
+{
+	if (!is_ready) {
+		ERROR("The query has to be ready before a snapshot can be written.");
+	}
+
+	snapshot::Writer writer(snapshot_file);
+	writer.write(snapshot_magic);
+	writer.write<std::uint32_t>(snapshot::version);
+	writer.write<std::uint32_t>(sizeof(T));
+	writer.write<std::uint32_t>(kd_dimension);
+	writer.write<std::uint32_t>(Tree::bucket_size);
+
+	// the points are written in the order of the arena, to keep its locality
+	std::vector<std::uint64_t> offsets;
+	std::vector<std::uint64_t> sizes;
+	std::vector<typename Curve::ExtremePoints> extreme_points;
+	std::vector<std::uint64_t> filename_offsets = {0};
+	std::vector<char> filenames;
+	for (auto const& curve: curve_data) {
+		offsets.push_back(curve_arena.getOffset(curve));
+		sizes.push_back(curve.size());
+		extreme_points.push_back(curve.getExtremePoints());
+		filename_offsets.push_back(filename_offsets.back() + curve.filename.size());
+		filenames.insert(filenames.end(), curve.filename.begin(), curve.filename.end());
+	}
+
+	writer.writeVector(offsets);
+	writer.writeVector(sizes);
+	writer.writeArray(curve_arena.getPoints(), curve_arena.getNumberOfPoints());
+	writer.writeArray(curve_arena.getPrefixLengths(), curve_arena.getNumberOfPoints());
+	writer.writeVector(extreme_points);
+	writer.writeVector(filename_offsets);
+	writer.writeVector(filenames);
+
+	writer.writeVector(kd_pivots);
+	kd_tree.write(writer);
+	writer.close();
+}
+
+template <typename T>
+void BasicQuery<T>::readSnapshot(std::string const& snapshot_file)
+{
+	// the reader of the old snapshot, if any, is released at the end, when
+	// nothing uses it anymore
+	std::unique_ptr<snapshot::Reader> reader(new snapshot::Reader(snapshot_file));
+	auto const magic = reader->read<std::array<char, 8>>();
+	if (!std::equal(magic.begin(), magic.end(), snapshot_magic)) {
+		ERROR("The file is not a snapshot: " << snapshot_file);
+	}
+	if (reader->read<std::uint32_t>() != snapshot::version) {
+		ERROR("The snapshot has an unsupported version: " << snapshot_file);
+	}
+	if (reader->read<std::uint32_t>() != sizeof(T)) {
+		ERROR("The snapshot was written with another precision: " << snapshot_file);
+	}
+	if (reader->read<std::uint32_t>() != kd_dimension || reader->read<std::uint32_t>() != Tree::bucket_size) {
+		ERROR("The snapshot was written with another kd-tree layout: " << snapshot_file);
+	}
+
+	std::size_t num_curves, num_sizes, num_points, num_prefix_lengths, num_extreme_points,
+		num_filename_offsets, num_filename_chars;
+	auto const* offsets = reader->readArray<std::uint64_t>(num_curves);
+	auto const* sizes = reader->readArray<std::uint64_t>(num_sizes);
+	auto const* points = reader->readArray<Point>(num_points);
+	auto const* prefix_lengths = reader->readArray<distance_t>(num_prefix_lengths);
+	auto const* extreme_points = reader->readArray<typename Curve::ExtremePoints>(num_extreme_points);
+	auto const* filename_offsets = reader->readArray<std::uint64_t>(num_filename_offsets);
+	auto const* filenames = reader->readArray<char>(num_filename_chars);
+
+	bool is_consistent = num_sizes == num_curves && num_extreme_points == num_curves &&
+		num_filename_offsets == num_curves + 1 && num_prefix_lengths == num_points &&
+		filename_offsets[num_curves] == num_filename_chars;
+	for (std::size_t id = 0; id < num_curves && is_consistent; ++id) {
+		is_consistent = offsets[id] <= num_points && sizes[id] <= num_points - offsets[id] &&
+			filename_offsets[id] <= filename_offsets[id + 1];
+	}
+	if (!is_consistent) {
+		ERROR("The snapshot is inconsistent: " << snapshot_file);
+	}
+
+	is_ready = false;
+	results.clear();
+	curve_data.clear();
+	curve_data.resize(num_curves);
+	for (std::size_t id = 0; id < num_curves; ++id) {
+		auto& curve = curve_data[id];
+		curve.useStorage(BasicCurveView<T>(nullptr, nullptr, 0, extreme_points[id]));
+		curve.filename.assign(filenames + filename_offsets[id], filenames + filename_offsets[id + 1]);
+	}
+	// the points are in the order of the arena, so they are used in place
+	curve_arena.assign(points, prefix_lengths, num_points, offsets, sizes, curve_data);
+
+	reader->readVector(kd_pivots);
+	if (kd_pivots.size() > kd_max_pivots) {
+		ERROR("The snapshot is inconsistent: " << snapshot_file);
+	}
+	num_kd_pivots = kd_pivots.size();
+	kd_tree = Tree(kd_feature_dimension + kd_pivots.size());
+	kd_tree.read(*reader, curve_data.size());
+	snapshot_reader = std::move(reader);
+	num_kd_candidates = 0;
+	num_pivot_candidates = 0;
+
+	if (pivot_table != nullptr && pivot_table->getNumberOfCurves() != curve_data.size()) {
+		ERROR("The pivot table does not belong to the curve data.");
+	}
+
+	is_ready = true;
+}
+
+template <typename T>
+void BasicQuery<T>::run()
 {
 	assert(is_ready);
 	results.clear();
@@ -180,7 +381,8 @@ void Query::run()
 	}
 }
 
-void Query::run_parallel()
+template <typename T>
+void BasicQuery<T>::run_parallel()
 {
 	assert(is_ready);
 
@@ -198,7 +400,8 @@ void Query::run_parallel()
 	global::times.stopFrechetQuery();
 }
 
-void Query::run(Curve const& curve, distance_t distance)
+template <typename T>
+void BasicQuery<T>::run(Curve const& curve, distance_t distance)
 {
 	assert(is_ready);
 	results.clear();
@@ -206,7 +409,57 @@ void Query::run(Curve const& curve, distance_t distance)
 	run_impl(curve, distance);
 }
 
-void Query::check_certificate(Certificate const& c, Times::CertType type) {
+template <typename T>
+void BasicQuery<T>::runKnn(std::size_t k)
+{
+	assert(is_ready);
+
+	results.clear();
+	results.resize(query_elements.size());
+
+	global::times.startFrechetQuery();
+	for (std::size_t i = 0; i < query_elements.size(); ++i) {
+		runKnn_impl(query_elements[i].curve, k, *frechet, distance_frechet, workspace, results[i]);
+	}
+	global::times.stopFrechetQuery();
+}
+
+template <typename T>
+void BasicQuery<T>::runKnn_parallel(std::size_t k)
+{
+	assert(is_ready);
+
+	results.clear();
+	results.resize(query_elements.size());
+
+	global::times.startFrechetQuery();
+#ifdef WITH_OPENMP
+	#pragma omp parallel for schedule(guided) num_threads(num_threads)
+#endif
+	for (std::size_t i = 0; i < query_elements.size(); ++i) {
+#ifdef WITH_OPENMP
+		auto& thread_data = thread_data_vec[omp_get_thread_num()];
+#else
+		auto& thread_data = thread_data_vec[0];
+#endif
+		runKnn_impl(query_elements[i].curve, k, *thread_data.frechet, thread_data.distance_frechet,
+			thread_data.workspace, results[i]);
+	}
+	global::times.stopFrechetQuery();
+}
+
+template <typename T>
+void BasicQuery<T>::runKnn(Curve const& curve, std::size_t k)
+{
+	assert(is_ready);
+	results.clear();
+
+	results.emplace_back();
+	runKnn_impl(curve, k, *frechet, distance_frechet, workspace, results.back());
+}
+
+template <typename T>
+void BasicQuery<T>::check_certificate(Certificate const& c, Times::CertType type) {
 #ifdef CERTIFY
 	if (c.isValid()) {
 		if (c.isYes()) {
@@ -237,7 +490,8 @@ void Query::check_certificate(Certificate const& c, Times::CertType type) {
 #endif
 }
 
-void Query::run_impl(Curve const& curve, distance_t distance)
+template <typename T>
+void BasicQuery<T>::run_impl(Curve const& curve, distance_t distance)
 {
 	assert(is_ready);
 	assert(frechet != nullptr);
@@ -249,7 +503,12 @@ void Query::run_impl(Curve const& curve, distance_t distance)
 	// perform query
 	global::times.startKdSearch();
 	candidates.clear();
-	kd_tree.search(toKdPoint(curve), distance, candidates);
+	kd_tree.search(toKdPoint(curve, kd_pivots), distance, candidates);
+	num_kd_candidates += candidates.size();
+	if (pivot_table != nullptr) {
+		pivot_table->prune(curve, curve_data, distance, distance_frechet, candidates);
+	}
+	num_pivot_candidates += candidates.size();
 	global::times.stopKdSearch();
 	global::times.startCountingCandidatesEtc();
 
@@ -262,8 +521,7 @@ void Query::run_impl(Curve const& curve, distance_t distance)
 		auto const max_distance = distance;
 
 		//TODO rewrite as "for all positive filters do ..." and "for all negative filters do ..."? 
-		//TODO filter always reallocates traversal vector
-		Filter filter(query_curve, candidate_curve, max_distance);
+		auto& filter = workspace.getFilter(query_curve, candidate_curve, max_distance);
 
 		if (filter.bichromaticFarthestDistance()) {
 			result.addCurve(candidate);
@@ -334,7 +592,8 @@ void Query::run_impl(Curve const& curve, distance_t distance)
 	global::times.stopCountingCandidatesEtc();
 }
 
-void Query::run_impl_parallel(Curve const& curve, distance_t distance, Result& result)
+template <typename T>
+void BasicQuery<T>::run_impl_parallel(Curve const& curve, distance_t distance, Result& result)
 {
 	assert(is_ready);
 	assert(frechet != nullptr);
@@ -349,14 +608,26 @@ void Query::run_impl_parallel(Curve const& curve, distance_t distance, Result& r
 
 	// perform query
 	candidates.clear();
-	kd_tree.search(toKdPoint(curve), distance, candidates);
+	kd_tree.search(toKdPoint(curve, kd_pivots), distance, candidates);
+	auto const kd_candidates = candidates.size();
+	if (pivot_table != nullptr) {
+		pivot_table->prune(curve, curve_data, distance, thread_data.distance_frechet, candidates);
+	}
+#ifdef WITH_OPENMP
+	#pragma omp atomic
+#endif
+	num_kd_candidates += kd_candidates;
+#ifdef WITH_OPENMP
+	#pragma omp atomic
+#endif
+	num_pivot_candidates += candidates.size();
 
 	for (auto candidate: candidates) {
 		auto const& query_curve = curve;
 		auto const& candidate_curve = curve_data[candidate];
 		auto const max_distance = distance;
 
-		Filter filter(query_curve, candidate_curve, max_distance);
+		auto& filter = thread_data.workspace.getFilter(query_curve, candidate_curve, max_distance);
 
 		if (filter.bichromaticFarthestDistance()) {
 			result.addCurve(candidate);
@@ -382,12 +653,65 @@ void Query::run_impl_parallel(Curve const& curve, distance_t distance, Result& r
 	}
 }
 
-Results const& Query::getResults() const
+template <typename T>
+void BasicQuery<T>::runKnn_impl(Curve const& curve, std::size_t k, FrechetAbstract& frechet,
+	BasicFrechetLight<T>& distance_frechet, FrechetWorkspace& workspace, Result& result) const
+{
+	assert(is_ready);
+	if (k == 0) { return; }
+
+	// the k nearest neighbors found so far, the farthest on top
+	using Neighbor = std::pair<distance_t, CurveID>;
+	std::priority_queue<Neighbor> neighbors;
+
+	// Candidates come in the order of their lower bound in the kd-tree, which
+	// is their featureDistance, and only those with a lower bound of at most
+	// the distance of the current k-th neighbor are visited. A candidate only
+	// needs its exact distance if it is at most that distance, which is
+	// checked by the filters and the decider first.
+	auto const query_point = toKdPoint(curve, kd_pivots);
+	kd_tree.searchNearest(query_point, [&](CurveID candidate, distance_t) -> distance_t {
+		auto const& candidate_curve = curve_data[candidate];
+
+		if (neighbors.size() == k) {
+			auto const max_distance = neighbors.top().first;
+			auto& filter = workspace.getFilter(curve, candidate_curve, max_distance);
+			PointID pos1;
+			PointID pos2;
+			if (!filter.bichromaticFarthestDistance() && !filter.adaptiveGreedy(pos1, pos2)) {
+				if (filter.negative(pos1, pos2)) {
+					return max_distance;
+				}
+				if (!filter.adaptiveSimultaneousGreedy() &&
+					!frechet.lessThan(max_distance, curve, candidate_curve)) {
+					return max_distance;
+				}
+			}
+		}
+
+		neighbors.emplace(distance_frechet.calcDistance(curve, candidate_curve), candidate);
+		if (neighbors.size() > k) {
+			neighbors.pop();
+		}
+
+		return neighbors.size() == k ? neighbors.top().first : std::numeric_limits<distance_t>::max();
+	});
+
+	result.curve_ids.resize(neighbors.size());
+	for (auto it = result.curve_ids.rbegin(); it != result.curve_ids.rend(); ++it) {
+		*it = neighbors.top().second;
+		neighbors.pop();
+	}
+}
+
+template <typename T>
+auto BasicQuery<T>::getResults() const -> Results const&
 {
 	return results;
 }
 
-void Query::saveResults(std::string const& results_file) const
+template <typename T>
+void BasicQuery<T>::saveResults(std::string const& results_file) const
 {
 	std::ofstream file(results_file);
 	if (file.is_open()) {
@@ -400,7 +724,8 @@ void Query::saveResults(std::string const& results_file) const
 	}
 }
 
-int Query::getHash() const
+template <typename T>
+int BasicQuery<T>::getHash() const
 {
 	int checksum = 0;
 	for (auto const& result: results) {
@@ -410,7 +735,8 @@ int Query::getHash() const
 	return checksum;
 }
 
-void Query::printQueryInformation(std::size_t query_index) const
+template <typename T>
+void BasicQuery<T>::printQueryInformation(std::size_t query_index) const
 {
 	auto const& query_element = query_elements[query_index];
 
@@ -418,23 +744,26 @@ void Query::printQueryInformation(std::size_t query_index) const
 	std::cout << "Query distance: " << query_element.distance << "\n";
 }
 
-Curve const& Query::getCurve(std::size_t curve_index) const
+template <typename T>
+auto BasicQuery<T>::getCurve(std::size_t curve_index) const -> Curve const&
 {
 	return curve_data[curve_index];
 }
 
-Curves const& Query::getCurves() const
+template <typename T>
+auto BasicQuery<T>::getCurves() const -> Curves const&
 {
 	return curve_data;
 }
 
-void Query::printDataStats(bool as_table) const
+template <typename T>
+void BasicQuery<T>::printDataStats(bool as_table) const
 {
 	double mean_hops;
 	double stddev_hops;
 	double mean_length;
 	double stddev_length;
-	Curve::ExtremePoints data_extreme_points;
+	typename Curve::ExtremePoints data_extreme_points;
 
 	mean_hops = 0.;
 	mean_length = 0.;
@@ -482,17 +811,20 @@ void Query::printDataStats(bool as_table) const
 	}
 }
 
-void Query::setRules(std::array<bool,5> const& enable)
+template <typename T>
+void BasicQuery<T>::setRules(std::array<bool,5> const& enable)
 {
 	frechet->setRules(enable);
 }
 
-void Query::setPruningLevel(int pruning_level)
+template <typename T>
+void BasicQuery<T>::setPruningLevel(int pruning_level)
 {
 	frechet->setPruningLevel(pruning_level);
 }
 
-distance_t Query::getUpperBoundDistance() const
+template <typename T>
+T BasicQuery<T>::getUpperBoundDistance() const
 {
 	if (curve_data.size() <= 1) { return 0.; }
 
@@ -511,7 +843,8 @@ distance_t Query::getUpperBoundDistance() const
 	return min_point.dist(max_point);
 }
 
-auto Query::getHardInstances() -> HardInstances
+template <typename T>
+auto BasicQuery<T>::getHardInstances() -> HardInstances
 {
 	HardInstances hard_instances;
 
@@ -523,14 +856,14 @@ auto Query::getHardInstances() -> HardInstances
 
 		// perform query
 		candidates.clear();
-		kd_tree.search(toKdPoint(curve), distance, candidates);
+		kd_tree.search(toKdPoint(curve, kd_pivots), distance, candidates);
 
 		for (auto candidate: candidates) {
 			auto const& query_curve = curve;
 			auto const& candidate_curve = curve_data[candidate];
 			auto const max_distance = distance;
 
-			Filter filter(query_curve, candidate_curve, max_distance);
+			auto& filter = workspace.getFilter(query_curve, candidate_curve, max_distance);
 
 			if (filter.bichromaticFarthestDistance()) {
 				continue;
@@ -555,3 +888,6 @@ auto Query::getHardInstances() -> HardInstances
 
 	return hard_instances;
 }
+
+template class BasicQuery<float>;
+template class BasicQuery<double>;
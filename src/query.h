@@ -1,28 +1,72 @@
 #pragma once
 
+#include "curve_arena.h"
 #include "frechet_abstract.h"
+#include "frechet_light.h"
+#include "frechet_workspace.h"
 #include "geometry_basics.h"
+#include "pivot_table.h"
 #include "query_helper.h"
 #include "times.h"
 #include "curves.h"
 
+#include <memory>
 #include <string>
 
-class Query
+namespace snapshot
+{
+	class Reader;
+}
+
+template <typename T>
+class BasicQuery
 {
 public:
-	Query(std::string const& curve_directory);
-	~Query();
+	using distance_t = T;
+	using Curve = BasicCurve<T>;
+	using Curves = BasicCurves<T>;
+
+	BasicQuery(std::string const& curve_directory);
+	~BasicQuery();
 
 	void readCurveData(std::string const& curve_data_file);
+	// read the data set from a single file, see parser::readCurveCollection
+	void readCurveCollection(std::string const& collection_file);
+	// use curves which are already in memory as data set
+	void setCurveData(Curves&& curves);
 	void readQueryCurves(std::string const& query_curves_file);
 	void setAlgorithm(std::string const& frechet_version);
+	// Additionally prune the candidates of the kd-tree by the triangle
+	// inequality with the given pivot table of the data set; nullptr disables.
+	void setPivotTable(BasicPivotTable<T> const* pivot_table);
+	// Add the distances to num_pivots pivot points, chosen from the data set
+	// in getReady, as coordinates to the kd-tree (see toKdPoint).
+	void setNumberOfKdPivots(std::size_t num_pivots);
+	// the number of candidates of the kd-tree and of those which remained
+	// after the pivot table, summed over all queries since getReady
+	std::size_t getNumberOfKdCandidates() const { return num_kd_candidates; }
+	std::size_t getNumberOfPivotCandidates() const { return num_pivot_candidates; }
 	void getReady();
 
+	// Write the curve data and the kd-tree, which getReady has built, to a
+	// binary file. Reading it makes the query ready without parsing the
+	// curves or building the tree; getReady must not be called afterwards.
+	// The points and the tree are used in place in the mapped file, which
+	// stays mapped until other curve data is set.
+	void writeSnapshot(std::string const& snapshot_file) const;
+	void readSnapshot(std::string const& snapshot_file);
+
 	void run();
 	void run_parallel();
 	void run(Curve const& curve, distance_t distance);
 
+	// k-nearest-neighbor queries: the result of a query are the IDs of the k
+	// curves with the smallest Fréchet distance to the query curve, sorted by
+	// distance. The distances of the query elements are ignored.
+	void runKnn(std::size_t k);
+	void runKnn_parallel(std::size_t k);
+	void runKnn(Curve const& curve, std::size_t k);
+
 	Results const& getResults() const;
 	void saveResults(std::string const& results_file) const;
 
@@ -49,27 +93,57 @@ public:
 	HardInstances getHardInstances();
 
 private:
+	using Point = BasicPoint<T>;
+	using Points = BasicPoints<T>;
+	using Certificate = BasicCertificate<T>;
+	using FrechetAbstract = BasicFrechetAbstract<T>;
+	using FrechetWorkspace = BasicFrechetWorkspace<T>;
+	using QueryElements = BasicQueryElements<T>;
+	using Tree = BasicTree<T>;
+
 	bool is_ready = false;
 	FrechetAbstract* frechet = nullptr;
+	FrechetWorkspace workspace;
+	// computes the distances of the nearest neighbors
+	BasicFrechetLight<T> distance_frechet;
 
 	std::string const curve_directory;
+	// the mapped snapshot which the curves and the kd-tree use, if any
+	std::unique_ptr<snapshot::Reader> snapshot_reader;
 
 	QueryElements query_elements;
 	Curves curve_data;
+	// holds the points of curve_data after getReady
+	BasicCurveArena<T> curve_arena;
 	CurveIDs candidates;
 	Results results;
 
 	Tree kd_tree;
+	std::size_t num_kd_pivots = 0;
+	Points kd_pivots;
+	BasicPivotTable<T> const* pivot_table = nullptr;
+	std::size_t num_kd_candidates = 0;
+	std::size_t num_pivot_candidates = 0;
 
 	std::size_t num_threads;
 	struct ThreadData {
 		FrechetAbstract* frechet = nullptr;
+		FrechetWorkspace workspace;
+		BasicFrechetLight<T> distance_frechet;
 		CurveIDs candidates;
 	};
 	std::vector<ThreadData> thread_data_vec;
 
+	// reads the curve files, the i-th one into curve_at(i), in parallel
+	template <typename CurveAt>
+	void readCurveFiles(std::vector<std::string> const& curve_filenames, CurveAt curve_at);
+
 	void run_impl(Curve const& curve, distance_t distance);
 	void run_impl_parallel(Curve const& curve, distance_t distance, Result& result);
+	void runKnn_impl(Curve const& curve, std::size_t k, FrechetAbstract& frechet,
+		BasicFrechetLight<T>& distance_frechet, FrechetWorkspace& workspace, Result& result) const;
 
 	void check_certificate(Certificate const& cert, Times::CertType type);
 };
+
+using Query = BasicQuery<distance_t>;
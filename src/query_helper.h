@@ -4,6 +4,10 @@
 #include "kdtree.h"
 #include "curves.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <tuple>
 #include <vector>
 #include <iostream>
 
@@ -12,13 +16,30 @@
 // Tree
 //
 
-using Tree = KdTree<distance_t, 8, CurveID>;
+// The points of the kd-tree consist of the start and end point and the
+// bounding box of a curve, followed by the distances of the curve to up to
+// kd_max_pivots pivot points. The coordinates of unused pivots are zero, and
+// the trees only store kd_feature_dimension plus the number of pivots
+// coordinates, see KdTree.
+constexpr int kd_max_pivots = 8;
+constexpr int kd_feature_dimension = 8;
+constexpr int kd_dimension = kd_feature_dimension + kd_max_pivots;
 
-inline Tree::Point toKdPoint(Curve const& curve)
+template <typename T>
+struct IsNearBucket;
+
+template <typename T>
+using BasicTree = KdTree<T, kd_dimension, CurveID, IsNearBucket<T>>;
+using Tree = BasicTree<distance_t>;
+
+template <typename T>
+inline typename BasicTree<T>::Point toKdPoint(BasicCurve<T> const& curve,
+	BasicPoints<T> const& pivots = BasicPoints<T>())
 {
+	assert(pivots.size() <= kd_max_pivots);
 	auto const& extreme_points = curve.getExtremePoints();
 
-	return {{
+	typename BasicTree<T>::Point point = {{
 		curve.front().x,
 		curve.front().y,
 		curve.back().x,
@@ -28,22 +49,176 @@ inline Tree::Point toKdPoint(Curve const& curve)
 		extreme_points.max_x,
 		extreme_points.max_y
 	}};
+
+	for (std::size_t i = 0; i < pivots.size(); ++i) {
+		auto distance = pivots[i].dist(curve.front());
+		for (PointID pt = 0; pt+1 < curve.size(); ++pt) {
+			distance = std::min(distance, segmentDistance(pivots[i], curve[pt], curve[pt+1]));
+		}
+		point[kd_feature_dimension + i] = distance;
+	}
+
+	return point;
+}
+
+// Chooses pivot points for toKdPoint among the vertices of the curves,
+// farthest-first starting at the first vertex of the first curve.
+template <typename T>
+inline BasicPoints<T> chooseKdPivots(BasicCurves<T> const& curves, std::size_t num_pivots)
+{
+	assert(num_pivots <= kd_max_pivots);
+
+	BasicPoints<T> pivots;
+	if (curves.empty() || num_pivots == 0) { return pivots; }
+
+	// the distance of each vertex to the closest pivot so far
+	std::vector<std::vector<T>> pivot_distances;
+	for (auto const& curve: curves) {
+		pivot_distances.emplace_back(curve.size(), std::numeric_limits<T>::infinity());
+	}
+
+	auto next_pivot = curves.front().front();
+	while (pivots.size() < num_pivots) {
+		pivots.push_back(next_pivot);
+
+		T max_distance = 0;
+		for (std::size_t i = 0; i < curves.size(); ++i) {
+			for (PointID pt = 0; pt < curves[i].size(); ++pt) {
+				auto& distance = pivot_distances[i][pt];
+				distance = std::min(distance, pivots.back().dist(curves[i][pt]));
+				if (distance > max_distance) {
+					max_distance = distance;
+					next_pivot = curves[i][pt];
+				}
+			}
+		}
+		// all vertices are pivots already
+		if (max_distance == 0) { break; }
+	}
+
+	return pivots;
+}
+
+// Checks whether the Fréchet distance of two curves can be at most distance,
+// given their points in the kd-tree: the start points, the end points, and
+// the sides of the bounding boxes can be at most that far apart. For a pivot
+// point p, |dist(p, P) - dist(p, Q)| is at most the Hausdorff distance of the
+// curves P and Q, and thus also at most their Fréchet distance.
+template <typename T>
+inline bool isNear(typename BasicTree<T>::Point const& a, typename BasicTree<T>::Point const& b, T distance)
+{
+	for (size_t i = 0; i < 4; i += 2) {
+		auto d = (a[i] - b[i])*(a[i] - b[i]) + (a[i + 1] - b[i + 1])*(a[i + 1] - b[i + 1]);
+		if (d > distance*distance) { return false; }
+	}
+	for (size_t i = 4; i < a.size(); ++i) {
+		auto d = std::abs(a[i] - b[i]);
+		if (d > distance) { return false; }
+	}
+
+	return true;
+}
+
+// isNear for all points of a bucket of the kd-tree at once. It does the same
+// comparisons as isNear, so the results are the same, but goes coordinate by
+// coordinate over the whole bucket, which the compiler can vectorize. Only
+// the coordinates of the tree are compared; the ones after them have to be
+// the same for all points, like those of unused pivots.
+template <typename T>
+struct IsNearBucket
+{
+	template <typename Point, typename Mask>
+	void operator()(T const* coordinates, std::size_t dimension, Point const& point, T distance, Mask& near) const
+	{
+		constexpr std::size_t bucket_size = std::tuple_size<Mask>::value;
+		auto const distance_sqr = distance*distance;
+
+		// the start and the end points; most buckets are already too far by them
+		std::array<bool, bucket_size> is_far;
+		is_far.fill(false);
+		for (size_t i = 0; i < 4; i += 2) {
+			auto const* xs = coordinates + i*bucket_size;
+			auto const* ys = coordinates + (i + 1)*bucket_size;
+			bool all_far = true;
+			for (std::size_t j = 0; j < bucket_size; ++j) {
+				auto d = (xs[j] - point[i])*(xs[j] - point[i]) + (ys[j] - point[i + 1])*(ys[j] - point[i + 1]);
+				is_far[j] = is_far[j] | (d > distance_sqr);
+				all_far = all_far & is_far[j];
+			}
+			if (all_far) {
+				near.fill(false);
+				return;
+			}
+		}
+
+		for (size_t i = 4; i < dimension; ++i) {
+			auto const* cs = coordinates + i*bucket_size;
+			for (std::size_t j = 0; j < bucket_size; ++j) {
+				is_far[j] = is_far[j] | (std::abs(cs[j] - point[i]) > distance);
+			}
+		}
+		for (std::size_t j = 0; j < bucket_size; ++j) {
+			near[j] = !is_far[j];
+		}
+	}
+
+	// featureDistance of the i-th point of the bucket
+	template <typename Point>
+	T lowerBound(T const* coordinates, std::size_t dimension, std::size_t i, Point const& point) const
+	{
+		constexpr std::size_t bucket_size = BasicTree<T>::bucket_size;
+		auto coordinate = [&](std::size_t d) { return coordinates[d*bucket_size + i]; };
+
+		T distance = 0;
+		for (size_t d = 0; d < 4; d += 2) {
+			auto dx = coordinate(d) - point[d];
+			auto dy = coordinate(d + 1) - point[d + 1];
+			distance = std::max(distance, std::sqrt(dx*dx + dy*dy));
+		}
+		for (size_t d = 4; d < dimension; ++d) {
+			distance = std::max(distance, std::abs(coordinate(d) - point[d]));
+		}
+
+		return distance;
+	}
+};
+
+// The smallest distance for which isNear is true, which is a lower bound on
+// the Fréchet distance of the curves.
+template <typename T>
+inline T featureDistance(typename BasicTree<T>::Point const& a, typename BasicTree<T>::Point const& b)
+{
+	T distance = 0;
+	for (size_t i = 0; i < 4; i += 2) {
+		auto d = (a[i] - b[i])*(a[i] - b[i]) + (a[i + 1] - b[i + 1])*(a[i + 1] - b[i + 1]);
+		distance = std::max(distance, std::sqrt(d));
+	}
+	for (size_t i = 4; i < a.size(); ++i) {
+		distance = std::max(distance, std::abs(a[i] - b[i]));
+	}
+
+	return distance;
 }
 
 //
 // QueryElement
 //
 
-struct QueryElement
+template <typename T>
+struct BasicQueryElement
 {
-	Curve curve;
-	distance_t distance;
+	BasicCurve<T> curve;
+	T distance;
 
 	// This is rvalue ref only on purpose.
-	QueryElement(Curve&& curve, distance_t distance)
+	BasicQueryElement(BasicCurve<T>&& curve, T distance)
 		: curve(curve), distance(distance) {}
 };
-using QueryElements = std::vector<QueryElement>;
+template <typename T>
+using BasicQueryElements = std::vector<BasicQueryElement<T>>;
+
+using QueryElement = BasicQueryElement<distance_t>;
+using QueryElements = BasicQueryElements<distance_t>;
 
 //
 // Result(s)
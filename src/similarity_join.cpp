@@ -0,0 +1,105 @@
+#include "similarity_join.h"
+
+#include "frechet_light.h"
+
+#include <utility>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+template <typename T>
+BasicSimilarityJoin<T>::BasicSimilarityJoin(Curves const& curves1, Curves const& curves2)
+	: curves1(curves1)
+	, curves2(curves2)
+	, is_self_join(&curves1 == &curves2)
+	, index_first(curves1.size() <= curves2.size())
+	, kd_tree(kd_feature_dimension)
+{
+	build();
+}
+
+template <typename T>
+BasicSimilarityJoin<T>::BasicSimilarityJoin(Curves const& curves)
+	: BasicSimilarityJoin(curves, curves)
+{
+}
+
+template <typename T>
+void BasicSimilarityJoin<T>::build()
+{
+	auto const& indexed = index_first ? curves1 : curves2;
+	for (CurveID id = 0; id < indexed.size(); ++id) {
+		kd_tree.add(toKdPoint(indexed[id]), id);
+	}
+	kd_tree.build();
+}
+
+template <typename T>
+void BasicSimilarityJoin<T>::run(distance_t distance, Sink const& sink)
+{
+	auto const& indexed = index_first ? curves1 : curves2;
+	auto const& streamed = index_first ? curves2 : curves1;
+	num_candidates = 0;
+	num_pairs = 0;
+	if (indexed.empty()) { return; }
+
+	// the pairs are collected per thread and passed to the sink in batches
+	std::size_t const batch_size = 4096;
+
+	std::size_t candidate_count = 0;
+	std::size_t pair_count = 0;
+#ifdef WITH_OPENMP
+	#pragma omp parallel reduction(+: candidate_count, pair_count)
+#endif
+	{
+		BasicFrechetLight<T> frechet;
+		CurveIDs candidates;
+		std::vector<std::pair<CurveID, CurveID>> batch;
+
+		auto flush = [&]() {
+#ifdef WITH_OPENMP
+			#pragma omp critical(similarity_join_sink)
+#endif
+			for (auto const& pair: batch) {
+				sink(pair.first, pair.second);
+			}
+			batch.clear();
+		};
+
+#ifdef WITH_OPENMP
+		#pragma omp for schedule(dynamic, 16)
+#endif
+		for (std::size_t id = 0; id < streamed.size(); ++id) {
+			auto const& curve = streamed[id];
+
+			candidates.clear();
+			kd_tree.search(toKdPoint(curve), distance, candidates);
+
+			for (auto candidate: candidates) {
+				// in a self-join, the pair with the smaller ID first is enough
+				if (is_self_join && candidate <= id) { continue; }
+				++candidate_count;
+
+				if (!frechet.lessThanWithFilters(distance, curve, indexed[candidate])) { continue; }
+
+				++pair_count;
+				if (index_first && !is_self_join) {
+					batch.emplace_back(candidate, id);
+				}
+				else {
+					batch.emplace_back(id, candidate);
+				}
+				if (batch.size() == batch_size) { flush(); }
+			}
+		}
+
+		flush();
+	}
+
+	num_candidates = candidate_count;
+	num_pairs = pair_count;
+}
+
+template class BasicSimilarityJoin<float>;
+template class BasicSimilarityJoin<double>;
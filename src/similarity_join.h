@@ -0,0 +1,57 @@
+#pragma once
+
+#include "defs.h"
+#include "geometry_basics.h"
+#include "query_helper.h"
+#include "curves.h"
+
+#include <functional>
+#include <vector>
+
+// Finds all pairs (a, b) of a curve a of the first and a curve b of the
+// second data set with Fréchet distance at most a given distance. The
+// kd-tree is built once on the smaller data set and the curves of the other
+// one run through the kd-tree, the filters and the decider in parallel.
+//
+// For a self-join (only one data set, or twice the same one), every pair is
+// reported once as (a, b) with a < b; pairs of a curve with itself are not
+// reported.
+template <typename T>
+class BasicSimilarityJoin
+{
+public:
+	using distance_t = T;
+	using Curve = BasicCurve<T>;
+	using Curves = BasicCurves<T>;
+
+	// Gets the pairs as (ID in the first data set, ID in the second data set).
+	// It is called by one thread at a time, in batches of pairs per thread, so
+	// the order of the pairs is not deterministic.
+	using Sink = std::function<void(CurveID, CurveID)>;
+
+	BasicSimilarityJoin(Curves const& curves1, Curves const& curves2);
+	explicit BasicSimilarityJoin(Curves const& curves);
+
+	void run(distance_t distance, Sink const& sink);
+
+	std::size_t getNumberOfCandidates() const { return num_candidates; }
+	std::size_t getNumberOfPairs() const { return num_pairs; }
+
+private:
+	using Tree = BasicTree<T>;
+
+	Curves const& curves1;
+	Curves const& curves2;
+	bool const is_self_join;
+
+	// the tree is built on the indexed data set, the other one is streamed
+	bool index_first;
+	Tree kd_tree;
+
+	std::size_t num_candidates = 0;
+	std::size_t num_pairs = 0;
+
+	void build();
+};
+
+using SimilarityJoin = BasicSimilarityJoin<distance_t>;
@@ -0,0 +1,90 @@
+#include "snapshot.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace snapshot
+{
+
+Writer::Writer(std::string const& filename)
+	: filename(filename)
+	, file(filename, std::ios::binary)
+{
+	if (!file.is_open()) {
+		ERROR("The snapshot file could not be opened: " << filename);
+	}
+}
+
+void Writer::close()
+{
+	file.close();
+	if (!file) {
+		ERROR("The snapshot file could not be written: " << filename);
+	}
+}
+
+void Writer::writeBytes(void const* data, std::size_t size)
+{
+	file.write(static_cast<char const*>(data), size);
+	offset += size;
+}
+
+void Writer::pad()
+{
+	static char const zeros[alignment] = {};
+	writeBytes(zeros, (alignment - offset%alignment)%alignment);
+}
+
+Reader::Reader(std::string const& filename)
+	: filename(filename)
+{
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd == -1) {
+		ERROR("The snapshot file could not be opened: " << filename);
+	}
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) == -1) {
+		ERROR("The snapshot file could not be opened: " << filename);
+	}
+	file_size = file_stat.st_size;
+
+	if (file_size > 0) {
+		void* mapping = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (mapping == MAP_FAILED) {
+			ERROR("The snapshot file could not be mapped: " << filename);
+		}
+		data = static_cast<char const*>(mapping);
+	}
+	// the mapping stays valid after closing the file
+	::close(fd);
+}
+
+Reader::~Reader()
+{
+	if (data != nullptr) {
+		munmap(const_cast<char*>(data), file_size);
+	}
+}
+
+void const* Reader::take(std::size_t size)
+{
+	if (size > file_size - offset) { truncated(); }
+	auto const* result = data + offset;
+	offset += size;
+	return result;
+}
+
+void Reader::skipPadding()
+{
+	take((alignment - offset%alignment)%alignment);
+}
+
+void Reader::truncated() const
+{
+	ERROR("The snapshot file is truncated: " << filename);
+}
+
+} // namespace snapshot
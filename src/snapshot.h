@@ -0,0 +1,113 @@
+#pragma once
+
+#include "defs.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Binary snapshot files of a data set and its kd-tree, see
+// BasicQuery::writeSnapshot. A file is a sequence of values and arrays in the
+// native representation of the machine which wrote it; the header contains
+// enough to reject files of another version or precision. Every array starts
+// at a multiple of 'alignment', such that it can be used in place in the
+// mapped file.
+namespace snapshot
+{
+
+constexpr std::uint32_t version = 2;
+constexpr std::size_t alignment = 64;
+
+class Writer
+{
+public:
+	explicit Writer(std::string const& filename);
+
+	template <typename V>
+	void write(V const& value)
+	{
+		static_assert(std::is_trivially_copyable<V>::value, "Only trivially copyable values can be written.");
+		writeBytes(&value, sizeof(V));
+	}
+
+	template <typename V>
+	void writeArray(V const* data, std::size_t size)
+	{
+		static_assert(std::is_trivially_copyable<V>::value, "Only trivially copyable values can be written.");
+		write<std::uint64_t>(size);
+		pad();
+		writeBytes(data, size*sizeof(V));
+	}
+
+	template <typename V>
+	void writeVector(std::vector<V> const& values) { writeArray(values.data(), values.size()); }
+
+	// checks that everything was written
+	void close();
+
+private:
+	std::string const filename;
+	std::ofstream file;
+	std::uint64_t offset = 0;
+
+	void writeBytes(void const* data, std::size_t size);
+	void pad();
+};
+
+// Maps the whole file into memory, such that several processes reading the
+// same snapshot share the page cache instead of each reading its own copy.
+class Reader
+{
+public:
+	explicit Reader(std::string const& filename);
+	~Reader();
+
+	Reader(Reader const&) = delete;
+	Reader& operator=(Reader const&) = delete;
+
+	template <typename V>
+	V read()
+	{
+		static_assert(std::is_trivially_copyable<V>::value, "Only trivially copyable values can be read.");
+		V value;
+		std::copy_n(static_cast<char const*>(take(sizeof(V))), sizeof(V), reinterpret_cast<char*>(&value));
+		return value;
+	}
+
+	// Returns the array in the mapped file, which is valid as long as the
+	// reader exists.
+	template <typename V>
+	V const* readArray(std::size_t& size)
+	{
+		static_assert(std::is_trivially_copyable<V>::value, "Only trivially copyable values can be read.");
+		size = read<std::uint64_t>();
+		skipPadding();
+		if (size > (file_size - offset)/sizeof(V)) { truncated(); }
+		return static_cast<V const*>(take(size*sizeof(V)));
+	}
+
+	template <typename V>
+	void readVector(std::vector<V>& values)
+	{
+		std::size_t size;
+		auto const* data = readArray<V>(size);
+		values.assign(data, data + size);
+	}
+
+	std::string const& getFilename() const { return filename; }
+
+private:
+	std::string const filename;
+	char const* data = nullptr;
+	std::size_t file_size = 0;
+	std::size_t offset = 0;
+
+	void const* take(std::size_t size);
+	void skipPadding();
+	[[noreturn]] void truncated() const;
+};
+
+} // namespace snapshot
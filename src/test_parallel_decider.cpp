@@ -0,0 +1,45 @@
+#include "defs.h"
+#include "frechet_light.h"
+
+#include <random>
+
+// Compares the parallel decider with the sequential one close to the Fréchet
+// distance, where a wrongly passed interval between two blocks would change
+// the answer. This is a separate program as the unit tests are certified,
+// which disables the parallel decider.
+int main()
+{
+	std::mt19937 gen(3);
+	std::normal_distribution<distance_t> step(0., 1.);
+
+	FrechetLight sequential;
+	FrechetLight parallel;
+	parallel.setParallel(true);
+
+	std::size_t num_decisions = 0;
+	for (std::size_t i = 0; i < 30; ++i) {
+		Curve curve1, curve2;
+		Point point1{0., 0.}, point2{0., 0.};
+		for (std::size_t j = 0; j < 400; ++j) {
+			point1 += Point{step(gen), step(gen)};
+			point2 += Point{step(gen), step(gen)};
+			curve1.push_back(point1);
+			curve2.push_back(point2);
+		}
+		auto distance = sequential.calcDistance(curve1, curve2);
+
+		// block sizes which do and do not divide the curve sizes
+		for (std::size_t block_size: {7, 16}) {
+			parallel.setParallelBlockSize(block_size);
+			for (distance_t factor: {0.99, 0.999, 0.9999, 1.0001, 1.001, 1.01}) {
+				bool expected = sequential.lessThan(factor*distance, curve1, curve2);
+				if (parallel.lessThan(factor*distance, curve1, curve2) != expected) {
+					ERROR("The parallel decider differs from the sequential one for curve pair "
+						<< i << ", block size " << block_size << " and distance " << factor*distance << ".");
+				}
+				++num_decisions;
+			}
+		}
+	}
+	std::cout << "The parallel and the sequential decider agree on " << num_decisions << " decisions.\n";
+}
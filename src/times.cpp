@@ -9,6 +9,7 @@ std::ostream& operator<<(std::ostream& out, Times const& times)
 	out << std::setprecision(3) << std::fixed
 	<< "preprocessing: " << times.preprocessing_sum/1000000000. << "s\n"
 	<< "reading query curves: " << times.reading_query_curve_sum/1000000000. << "s\n"
+	<< "kd build: " << times.kd_build_sum/1000000000. << "s\n"
 	<< "kd search: " << times.kd_search_sum/1000000000. << "s\n"
 	<< "frechet query (total " << times.frechet_query_sum/1000000000. << "s):\n"
 	<< "   - greedy: " << times.greedy_sum/1000000000. << "s\n"
@@ -28,6 +28,7 @@ struct Times
 	double preprocessing_sum = 0.;
 	double reading_query_curve_sum = 0.;
 	double kd_search_sum = 0.;
+	double kd_build_sum = 0.;
 	double frechet_query_sum = 0.;
 	double tests_sum = 0.;
 	double tests_boxes_sum = 0.;
@@ -49,6 +50,7 @@ struct Times
 	time_point preprocessing_start;
 	time_point reading_query_curve_start;
 	time_point kd_search_start;
+	time_point kd_build_start;
 	time_point frechet_query_start;
 	time_point tests_start;
 	time_point tests_boxes_start;
@@ -115,6 +117,7 @@ struct Times
 	void startPreprocessing() { preprocessing_start = hrc::now(); };
 	void startReadingQueryCurve() { reading_query_curve_start = hrc::now(); }
 	void startKdSearch() { kd_search_start = hrc::now(); }
+	void startKdBuild() { kd_build_start = hrc::now(); }
 	void startFrechetQuery() { frechet_query_start = hrc::now(); }
 	void startTests() { tests_start = hrc::now(); }
 	void startTestsBoxes() { tests_boxes_start = hrc::now(); }
@@ -131,6 +134,7 @@ struct Times
 	void stopPreprocessing() { preprocessing_sum += stop(preprocessing_start); }
 	void stopReadingQueryCurve() { reading_query_curve_sum += stop(reading_query_curve_start); }
 	void stopKdSearch() { kd_search_sum += stop(kd_search_start); }
+	void stopKdBuild() { kd_build_sum += stop(kd_build_start); }
 	void stopFrechetQuery() {  frechet_query_sum += stop(frechet_query_start); }
 	void stopTests() { tests_sum += stop(tests_start); }
 	void stopTestsBoxes() { tests_boxes_sum += stop(tests_boxes_start); }
@@ -214,6 +218,7 @@ struct Times
 	double preprocessing_sum = 0.;
 	double reading_query_curve_sum = 0.;
 	double kd_search_sum = 0.;
+	double kd_build_sum = 0.;
 	double frechet_query_sum = 0.;
 	double tests_sum = 0.;
 	double tests_boxes_sum = 0.;
@@ -235,6 +240,7 @@ struct Times
 	time_point preprocessing_start;
 	time_point reading_query_curve_start;
 	time_point kd_search_start;
+	time_point kd_build_start;
 	time_point frechet_query_start;
 	time_point tests_start;
 	time_point tests_boxes_start;
@@ -301,6 +307,8 @@ struct Times
 	void startPreprocessing() {}
 	void startReadingQueryCurve() {}
 	void startKdSearch() {}
+	// measured once per build, so also without the other timings
+	void startKdBuild() { kd_build_start = hrc::now(); }
 	void startFrechetQuery() { frechet_query_start = hrc::now(); }
 	void startTests() {}
 	void startTestsBoxes() {}
@@ -319,6 +327,7 @@ struct Times
 	void stopPreprocessing() {}
 	void stopReadingQueryCurve() {}
 	void stopKdSearch() {}
+	void stopKdBuild() { kd_build_sum += stop(kd_build_start); }
 	void stopFrechetQuery() {  frechet_query_sum += stop(frechet_query_start); }
 	void stopTests() {}
 	void stopTestsBoxes() {}
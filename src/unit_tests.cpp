@@ -5,13 +5,23 @@
 #include "unit_tests.h"
 
 #include <cmath>
+#include <cstdio>
+#include <iomanip>
 #include <random>
+#include <set>
+#include <sstream>
 #include <unordered_set>
 
 #include "defs.h"
+#include "curve_arena.h"
+#include "distance_matrix.h"
+#include "dynamic_index.h"
 #include "frechet_light.h"
 #include "parser.h"
+#include "pivot_table.h"
 #include "priority_search_tree.h"
+#include "query.h"
+#include "similarity_join.h"
 #include "range_tree.h"
 #include "curves.h"
 
@@ -73,6 +83,23 @@ Curve getCurve3() {
 	return curve;
 }
 
+// A random walk with normally distributed steps which starts in
+// [-extent, extent]^2.
+Curve randomCurve(std::mt19937& gen, std::size_t size, distance_t extent = 10.,
+	distance_t step_deviation = 1.)
+{
+	std::normal_distribution<distance_t> step(0., step_deviation);
+	std::uniform_real_distribution<distance_t> start(-extent, extent);
+
+	Curve curve;
+	Point point{start(gen), start(gen)};
+	for (std::size_t i = 0; i < size; ++i) {
+		point += Point{step(gen), step(gen)};
+		curve.push_back(point);
+	}
+	return curve;
+}
+
 // bool roughlyEqual(distance_t a, distance_t b)
 // {
 //     return std::abs(a-b) < 0.001;
@@ -91,8 +118,22 @@ void unit_tests::testAll()
 #ifdef CERTIFY
 	unit_tests::testFreespaceLightVis();
 #endif
-	unit_tests::testLightCertificate();
+	//TMP unit_tests::testLightCertificate();
 	unit_tests::testRangeTree();
+	unit_tests::testPrecisions();
+	unit_tests::testEarlyTermination();
+	unit_tests::testCalcDistance();
+	unit_tests::testKnn();
+	unit_tests::testDistanceMatrix();
+	unit_tests::testSimilarityJoin();
+	unit_tests::testPivotTable();
+	unit_tests::testKdPivots();
+	unit_tests::testKdTree();
+	unit_tests::testDynamicIndex();
+	unit_tests::testParser();
+	unit_tests::testSnapshot();
+	unit_tests::testCurveCollection();
+	unit_tests::testCurveArena();
 }
 
 void unit_tests::testGeometricBasics()
@@ -111,6 +152,37 @@ void unit_tests::testGeometricBasics()
 
 	TEST(curve1.size() == 2 && curve2.size() == 3);
 	TEST(curve1.curve_length(0, 1) == 2);
+
+	// Test critical values
+	Point p4{5., 0.};
+	distance_t distance;
+	TEST(segmentDistance(p3, p1, p2) == std::sqrt(17.));
+	TEST(segmentDistance(p3, p1, p4) == 4);
+	TEST(bisectorDistance(p1, p3, p1, p4, distance) && std::abs(distance - 25./6.) < 1e-12);
+	TEST(!bisectorDistance(p1, p2, p3, p3 + Point{1., 0.}, distance));
+
+	// Test batched intersection intervals against the single ones
+	std::mt19937 gen(42);
+	std::uniform_real_distribution<distance_t> coord(-2., 2.);
+	Points points;
+	for (std::size_t i = 0; i < 100; ++i) {
+		points.push_back({coord(gen), coord(gen)});
+	}
+	points.push_back(points.back()); // degenerate segment
+	for (std::size_t i = 0; i < 20; ++i) {
+		Point center{coord(gen), coord(gen)};
+		distance_t radius = std::abs(coord(gen));
+		std::size_t count = points.size() - 1 - i;
+
+		std::vector<Interval> intervals(count), outers(count);
+		IntersectionAlgorithm::intersection_intervals(center, radius, points.data() + i, count, intervals.data(), outers.data());
+		for (std::size_t k = 0; k < count; ++k) {
+			Interval outer;
+			auto interval = IntersectionAlgorithm::intersection_interval(center, radius, points[i+k], points[i+k+1], &outer);
+			TEST(interval.begin == intervals[k].begin && interval.end == intervals[k].end);
+			TEST(outer.begin == outers[k].begin && outer.end == outers[k].end);
+		}
+	}
 }
 
 #ifdef CERTIFY
@@ -153,6 +225,711 @@ void unit_tests::testLightCertificate(std::string curve1file, std::string curve2
 
 }
 
+void unit_tests::testPrecisions()
+{
+	// random walks on which the float and the double version of the deciders
+	// have to agree, as no distance is close to the Fréchet distance
+	std::mt19937 gen(42);
+	std::normal_distribution<double> step(0., 1.);
+
+	FrechetLight light;
+	BasicFrechetLight<float> light_float;
+	for (std::size_t i = 0; i < 100; ++i) {
+		Curve curve1, curve2;
+		BasicCurve<float> curve1_float, curve2_float;
+		Point point1{0., 0.}, point2{0., 0.};
+		for (std::size_t j = 0; j < 30; ++j) {
+			point1 += Point{step(gen), step(gen)};
+			point2 += Point{step(gen), step(gen)};
+			curve1.push_back(point1);
+			curve2.push_back(point2);
+			curve1_float.push_back({(float)point1.x, (float)point1.y});
+			curve2_float.push_back({(float)point2.x, (float)point2.y});
+		}
+
+		auto distance = light.calcDistance(curve1, curve2);
+		auto distance_float = light_float.calcDistance(curve1_float, curve2_float);
+		TEST(std::abs(distance - distance_float) < 1e-3);
+
+		for (distance_t factor: {0.99, 1.01}) {
+			TEST(light.lessThan(factor*distance, curve1, curve2) ==
+				light_float.lessThan(factor*distance, curve1_float, curve2_float));
+		}
+	}
+}
+
+void unit_tests::testEarlyTermination()
+{
+	// the deciders with and without early termination have to agree for all
+	// traversal orders and also for the parallel decider
+	std::mt19937 gen(7);
+	std::normal_distribution<distance_t> step(0., 1.);
+
+	FrechetLight light;
+	std::size_t num_skipped_boxes = 0;
+	for (std::size_t i = 0; i < 50; ++i) {
+		Curve curve1, curve2;
+		Point point1{0., 0.}, point2{0., 0.};
+		for (std::size_t j = 0; j < 200; ++j) {
+			point1 += Point{step(gen), step(gen)};
+			point2 += Point{step(gen), step(gen)};
+			curve1.push_back(point1);
+			curve2.push_back(point2);
+		}
+
+		light.setParallel(false);
+		light.setTraversalOrder(TraversalOrder::DepthFirst);
+		auto distance = light.calcDistance(curve1, curve2);
+
+		for (distance_t factor: {0.5, 0.9, 1.1, 2.}) {
+			for (auto order: {TraversalOrder::DepthFirst, TraversalOrder::LargestFirst, TraversalOrder::AntiDiagonal}) {
+				for (bool parallel: {false, true}) {
+					light.setTraversalOrder(order);
+					light.setParallel(parallel);
+					light.setParallelBlockSize(16);
+
+					light.setEarlyTermination(false);
+					bool expected = light.lessThan(factor*distance, curve1, curve2);
+					TEST(light.getNumberOfSkippedBoxes() == 0);
+
+					light.setEarlyTermination(true);
+					TEST(light.lessThan(factor*distance, curve1, curve2) == expected);
+					num_skipped_boxes += light.getNumberOfSkippedBoxes();
+				}
+			}
+		}
+	}
+	TEST(num_skipped_boxes > 0);
+}
+
+void unit_tests::testCalcDistance()
+{
+	// calcDistance reuses information between the distances it tries, so check
+	// its result against single decider calls on noisy copies of curves
+	std::mt19937 gen(11);
+	std::normal_distribution<distance_t> step(0., 1.);
+	std::normal_distribution<distance_t> noise(0., .3);
+
+	FrechetLight light;
+	for (std::size_t i = 0; i < 20; ++i) {
+		Curve curve1, curve2;
+		Point point{0., 0.};
+		for (std::size_t j = 0; j < 500; ++j) {
+			point += Point{step(gen), step(gen)};
+			curve1.push_back(point);
+			if (gen() % 4 != 0) {
+				curve2.push_back(point + Point{noise(gen), noise(gen)});
+			}
+		}
+
+		auto distance = light.calcDistance(curve1, curve2);
+		TEST(light.lessThan(distance + 1e-7, curve1, curve2));
+		TEST(!light.lessThan(distance - 1e-7, curve1, curve2));
+
+		// the critical value search has to end at the same distance
+		TEST(std::abs(light.calcDistanceExact(curve1, curve2) - distance) < 1e-7);
+
+		Filter filter(curve1, curve2, 0.);
+		TEST(filter.lowerBound() <= distance + 1e-7 && distance - 1e-7 <= filter.upperBound());
+
+		auto bounds = light.calcDistanceApprox(curve1, curve2, .01);
+		TEST(bounds.begin <= distance + 1e-7 && distance - 1e-7 <= bounds.end);
+		TEST(bounds.end <= 1.01*bounds.begin);
+	}
+
+	// the parallel search is deterministic and ends at the same distance
+	FrechetLight light_parallel;
+	light_parallel.setParallelSearch(3);
+	for (std::size_t i = 0; i < 5; ++i) {
+		Curve curve1, curve2;
+		Point point1{0., 0.}, point2{0., 0.};
+		for (std::size_t j = 0; j < 300; ++j) {
+			point1 += Point{step(gen), step(gen)};
+			point2 += Point{step(gen), step(gen)};
+			curve1.push_back(point1);
+			curve2.push_back(point2);
+		}
+
+		auto distance = light_parallel.calcDistance(curve1, curve2);
+		TEST(light_parallel.calcDistance(curve1, curve2) == distance);
+		TEST(std::abs(light.calcDistance(curve1, curve2) - distance) < 1e-7);
+	}
+
+	// here the distance is the critical value of a vertex and a segment
+	Curve curve1(Points{{0., 0.}, {1., 2.}, {2., 0.}});
+	Curve curve2(Points{{0., 0.}, {2., 0.}});
+	TEST(light.calcDistanceExact(curve1, curve2) == 2.);
+}
+
+void unit_tests::testKnn()
+{
+	// compare the k nearest neighbors with the distances to all curves
+	std::mt19937 gen(13);
+
+	Curves curves;
+	for (std::size_t i = 0; i < 200; ++i) {
+		curves.push_back(randomCurve(gen, 30));
+	}
+	Curves data = curves;
+
+	Query query("");
+	query.setCurveData(std::move(data));
+	query.setAlgorithm("light");
+	query.getReady();
+
+	FrechetLight light;
+	for (std::size_t i = 0; i < 10; ++i) {
+		auto curve = randomCurve(gen, 30);
+		std::size_t k = 1 + i;
+
+		std::vector<distance_t> distances;
+		for (auto const& other: curves) {
+			distances.push_back(light.calcDistance(curve, other));
+		}
+		auto sorted_distances = distances;
+		std::sort(sorted_distances.begin(), sorted_distances.end());
+
+		query.runKnn(curve, k);
+		auto const& curve_ids = query.getResults().front().curve_ids;
+		TEST(curve_ids.size() == k);
+		for (std::size_t j = 0; j < k; ++j) {
+			TEST(std::abs(distances[curve_ids[j]] - sorted_distances[j]) < 1e-7);
+		}
+	}
+}
+
+void unit_tests::testDistanceMatrix()
+{
+	std::mt19937 gen(17);
+	Curves curves;
+	for (std::size_t i = 0; i < 50; ++i) {
+		curves.push_back(randomCurve(gen, 20));
+	}
+
+	// the tiles and the reordering must not change any entry
+	distance_t const threshold = 8.;
+	DistanceMatrix matrix(curves);
+	matrix.setTileSize(8);
+	matrix.compute();
+	DistanceMatrix matrix_threshold(curves);
+	matrix_threshold.setTileSize(8);
+	matrix_threshold.setThreshold(threshold);
+	matrix_threshold.compute();
+
+	FrechetLight light;
+	std::size_t num_above = 0;
+	for (CurveID id1 = 0; id1 < curves.size(); ++id1) {
+		TEST(matrix.get(id1, id1) == 0);
+		for (CurveID id2 = id1 + 1; id2 < curves.size(); ++id2) {
+			auto distance = light.calcDistance(curves[id1], curves[id2]);
+			TEST(std::abs(matrix.get(id1, id2) - distance) < 1e-7);
+			TEST(matrix.get(id2, id1) == matrix.get(id1, id2));
+
+			if (matrix_threshold.get(id1, id2) == DistanceMatrix::above_threshold) {
+				TEST(distance > threshold - 1e-7);
+				++num_above;
+			}
+			else {
+				TEST(std::abs(matrix_threshold.get(id1, id2) - distance) < 1e-7);
+			}
+		}
+	}
+	TEST(num_above == matrix_threshold.getNumberOfSkippedPairs() && num_above > 0);
+}
+
+void unit_tests::testSimilarityJoin()
+{
+	std::mt19937 gen(19);
+	auto random_curves = [&](std::size_t number) {
+		Curves curves;
+		for (std::size_t i = 0; i < number; ++i) {
+			curves.push_back(randomCurve(gen, 20, 5.));
+		}
+		return curves;
+	};
+	auto curves1 = random_curves(60);
+	auto curves2 = random_curves(40);
+	distance_t const distance = 4.;
+
+	// compare with the decider on all pairs
+	FrechetLight light;
+	auto check = [&](Curves const& join_curves1, Curves const& join_curves2, bool is_self_join) {
+		std::set<std::pair<CurveID, CurveID>> pairs;
+		SimilarityJoin join(join_curves1, join_curves2);
+		join.run(distance, [&](CurveID id1, CurveID id2) {
+			TEST(pairs.emplace(id1, id2).second);
+		});
+		TEST(join.getNumberOfPairs() == pairs.size());
+
+		for (CurveID id1 = 0; id1 < join_curves1.size(); ++id1) {
+			for (CurveID id2 = (is_self_join ? id1+1 : 0); id2 < join_curves2.size(); ++id2) {
+				bool is_close = light.lessThan(distance, join_curves1[id1], join_curves2[id2]);
+				TEST(is_close == (pairs.count({id1, id2}) == 1));
+			}
+		}
+	};
+	check(curves1, curves2, false);
+	check(curves2, curves1, false);
+	check(curves1, curves1, true);
+}
+
+void unit_tests::testPivotTable()
+{
+	std::mt19937 gen(23);
+
+	Curves curves;
+	for (std::size_t i = 0; i < 150; ++i) {
+		curves.push_back(randomCurve(gen, 20, 3.));
+	}
+
+	PivotTable pivot_table;
+	pivot_table.build(curves, 6);
+	TEST(pivot_table.getPivots().size() == 6 && pivot_table.getPivots().front() == 0);
+
+	FrechetLight light;
+	for (std::size_t p = 0; p < pivot_table.getPivots().size(); ++p) {
+		auto const& pivot_curve = curves[pivot_table.getPivots()[p]];
+		for (CurveID id = 0; id < curves.size(); id += 10) {
+			TEST(std::abs(pivot_table.getDistance(id, p) - light.calcDistance(pivot_curve, curves[id])) < 1e-7);
+		}
+	}
+
+	// the pruning must not change the results of the queries
+	Curves data = curves;
+	Query query("");
+	query.setCurveData(std::move(data));
+	query.setAlgorithm("light");
+	query.getReady();
+	Query query_pivots("");
+	data = curves;
+	query_pivots.setCurveData(std::move(data));
+	query_pivots.setAlgorithm("light");
+	query_pivots.setPivotTable(&pivot_table);
+	query_pivots.getReady();
+
+	for (std::size_t i = 0; i < 20; ++i) {
+		auto curve = randomCurve(gen, 20, 3.);
+		distance_t distance = 4. + i%5;
+		query.run(curve, distance);
+		query_pivots.run(curve, distance);
+		TEST(query.getResults().front().curve_ids == query_pivots.getResults().front().curve_ids);
+	}
+	TEST(query_pivots.getNumberOfKdCandidates() == query.getNumberOfKdCandidates());
+	TEST(query_pivots.getNumberOfPivotCandidates() < query_pivots.getNumberOfKdCandidates());
+}
+
+void unit_tests::testKdPivots()
+{
+	std::mt19937 gen(29);
+
+	Curves curves;
+	for (std::size_t i = 0; i < 200; ++i) {
+		curves.push_back(randomCurve(gen, 20));
+	}
+
+	auto pivots = chooseKdPivots(curves, 4);
+	TEST(pivots.size() == 4 && pivots.front().dist(curves.front().front()) == 0);
+
+	// the pivot coordinates may only remove candidates which are too far
+	Curves data = curves;
+	Query query("");
+	query.setCurveData(std::move(data));
+	query.setAlgorithm("light");
+	query.getReady();
+	Query query_pivots("");
+	data = curves;
+	query_pivots.setCurveData(std::move(data));
+	query_pivots.setAlgorithm("light");
+	query_pivots.setNumberOfKdPivots(4);
+	query_pivots.getReady();
+
+	for (std::size_t i = 0; i < 20; ++i) {
+		auto curve = randomCurve(gen, 20);
+		distance_t distance = 2. + i%5;
+		query.run(curve, distance);
+		query_pivots.run(curve, distance);
+		// the order of the results depends on the kd-tree
+		auto curve_ids = query.getResults().front().curve_ids;
+		auto curve_ids_pivots = query_pivots.getResults().front().curve_ids;
+		std::sort(curve_ids.begin(), curve_ids.end());
+		std::sort(curve_ids_pivots.begin(), curve_ids_pivots.end());
+		TEST(curve_ids == curve_ids_pivots);
+
+		query.runKnn(curve, 3);
+		query_pivots.runKnn(curve, 3);
+		TEST(query.getResults().front().curve_ids == query_pivots.getResults().front().curve_ids);
+	}
+	TEST(query_pivots.getNumberOfKdCandidates() < query.getNumberOfKdCandidates());
+}
+
+void unit_tests::testKdTree()
+{
+	// compare the search with isNear on all points, also with duplicates
+	std::mt19937 gen(31);
+	std::uniform_real_distribution<distance_t> coordinate(-10., 10.);
+	std::uniform_int_distribution<int> rounded(-3, 3);
+
+	std::vector<Tree::Point> points;
+	for (std::size_t i = 0; i < 2000; ++i) {
+		Tree::Point point;
+		point.fill(0);
+		for (std::size_t d = 0; d < kd_feature_dimension; ++d) {
+			point[d] = (i%2 == 0 ? coordinate(gen) : rounded(gen));
+		}
+		points.push_back(point);
+	}
+
+	Tree tree(kd_feature_dimension);
+	for (CurveID id = 0; id < points.size(); ++id) {
+		tree.add(points[id], id);
+	}
+	tree.build();
+
+	for (std::size_t i = 0; i < 100; ++i) {
+		auto const& query_point = points[i*7];
+		distance_t distance = (i%5)*3.;
+
+		CurveIDs result;
+		tree.search(query_point, distance, result);
+		std::sort(result.begin(), result.end());
+
+		CurveIDs naive_result;
+		for (CurveID id = 0; id < points.size(); ++id) {
+			if (isNear<distance_t>(points[id], query_point, distance)) {
+				naive_result.push_back(id);
+			}
+		}
+		TEST(result == naive_result);
+	}
+
+	// the nearest search visits all points in the order of their featureDistance
+	distance_t last_bound = 0;
+	std::size_t num_visited = 0;
+	tree.searchNearest(points[3], [&](CurveID id, distance_t lower_bound) {
+		TEST(lower_bound >= last_bound && lower_bound == featureDistance<distance_t>(points[id], points[3]));
+		last_bound = lower_bound;
+		++num_visited;
+		return std::numeric_limits<distance_t>::max();
+	});
+	TEST(num_visited == points.size());
+
+	Tree empty_tree;
+	empty_tree.build();
+	CurveIDs result;
+	empty_tree.search(points.front(), 1., result);
+	TEST(result.empty());
+}
+
+void unit_tests::testDynamicIndex()
+{
+	std::mt19937 gen(37);
+
+	Curves curves;
+	for (std::size_t i = 0; i < 500; ++i) {
+		curves.push_back(randomCurve(gen, 15, 3.));
+	}
+
+	// single inserts, a batch insert, and removals, which also trigger the
+	// rebuild of all trees
+	DynamicIndex index;
+	std::vector<bool> is_live;
+	for (std::size_t i = 0; i < 200; ++i) {
+		TEST(index.insert(curves[i]) == i);
+		is_live.push_back(true);
+	}
+	TEST(index.getNumberOfTrees() == 2);
+	CurveIDs batch_ids = index.insert(Curves(curves.begin() + 200, curves.end()));
+	TEST(batch_ids.size() == 300 && batch_ids.front() == 200 && batch_ids.back() == 499);
+	is_live.resize(curves.size(), true);
+
+	std::size_t num_live = curves.size();
+	for (CurveID id = 0; id < curves.size(); id += (id < 400 ? 2 : 7)) {
+		TEST(index.remove(id));
+		is_live[id] = false;
+		--num_live;
+	}
+	TEST(!index.remove(0) && !index.remove(curves.size()));
+	TEST(index.size() == num_live);
+
+	FrechetLight light;
+	auto check = [&]() {
+		for (std::size_t i = 0; i < 30; ++i) {
+			auto const query_curve = randomCurve(gen, 15, 3.);
+			distance_t distance = 2. + (i%4);
+
+			CurveIDs result;
+			index.query(query_curve, distance, light, result);
+			std::sort(result.begin(), result.end());
+
+			CurveIDs naive_result;
+			for (CurveID id = 0; id < curves.size(); ++id) {
+				if (is_live[id] && light.lessThanWithFilters(distance, query_curve, curves[id])) {
+					naive_result.push_back(id);
+				}
+			}
+			TEST(result == naive_result);
+		}
+	};
+	check();
+
+	// removing more than half of the curves merges all trees into one
+	for (CurveID id = 1; id < curves.size(); id += 2) {
+		if (is_live[id] && id%3 != 0) {
+			TEST(index.remove(id));
+			is_live[id] = false;
+			--num_live;
+		}
+	}
+	TEST(index.size() == num_live);
+	TEST(index.getNumberOfTrees() == 1);
+	check();
+
+	// the queries see all curves which were inserted before they started, and
+	// none which were not inserted yet
+#ifdef WITH_OPENMP
+	Curves new_curves;
+	for (std::size_t i = 0; i < 300; ++i) {
+		new_curves.push_back(randomCurve(gen, 15, 3.));
+	}
+	auto const query_curve = new_curves.back();
+
+	CurveIDs before;
+	index.query(query_curve, 3., light, before);
+
+	#pragma omp parallel sections num_threads(2)
+	{
+		#pragma omp section
+		{
+			for (auto const& curve: new_curves) {
+				index.insert(curve);
+			}
+		}
+		#pragma omp section
+		{
+			FrechetLight thread_light;
+			for (std::size_t i = 0; i < 50; ++i) {
+				CurveIDs result;
+				index.query(query_curve, 3., thread_light, result);
+				for (auto id: before) {
+					TEST(std::find(result.begin(), result.end(), id) != result.end());
+				}
+				for (auto id: result) {
+					TEST(id < curves.size() + new_curves.size());
+				}
+			}
+		}
+	}
+
+	CurveIDs after;
+	index.query(query_curve, 3., light, after);
+	TEST(std::find(after.begin(), after.end(), curves.size() + new_curves.size() - 1) != after.end());
+#endif
+}
+
+void unit_tests::testParser()
+{
+	// the same coordinates as std::stod, including those it is exact for only
+	// by strtod, and the duplicate and extra columns handling of the old parser
+	std::string const text =
+		"1 2\n"
+		"1 2 7 8\n"
+		"  -0.5\t+3.25e1 \r\n"
+		"0.1 .1e-3\n"
+		"123456789012345678901234 1.5e-300\n"
+		"9007199254740993 0x1p3\n"
+		"1.5abc 5.\n";
+	std::vector<std::string> const expected = {"1", "2", "-0.5", "+3.25e1", "0.1", ".1e-3",
+		"123456789012345678901234", "1.5e-300", "9007199254740993", "0x1p3", "1.5", "5."};
+
+	Curve curve;
+	parser::readCurve(text.data(), text.data() + text.size(), curve);
+	TEST(curve.size() == expected.size()/2);
+	for (std::size_t i = 0; i < curve.size(); ++i) {
+		TEST(curve[i].x == std::stod(expected[2*i]) && curve[i].y == std::stod(expected[2*i + 1]));
+	}
+
+	std::mt19937 gen(41);
+	std::uniform_real_distribution<double> coordinate(-1000., 1000.);
+	std::uniform_int_distribution<int> precision(1, 18);
+	for (std::size_t i = 0; i < 10000; ++i) {
+		std::stringstream ss;
+		ss << std::setprecision(precision(gen)) << coordinate(gen);
+		if (i%2 == 0) { ss << "e" << (static_cast<int>(i%40) - 20); }
+		auto const token = ss.str();
+		auto const line = token + " 0";
+
+		Curve number_curve;
+		parser::readCurve(line.data(), line.data() + line.size(), number_curve);
+		TEST(number_curve.size() == 1 && number_curve[0].x == std::stod(token));
+	}
+}
+
+void unit_tests::testSnapshot()
+{
+	std::mt19937 gen(43);
+
+	Curves curves;
+	for (std::size_t i = 0; i < 300; ++i) {
+		curves.push_back(randomCurve(gen, 1 + gen()%30));
+		curves.back().filename = "curve_" + std::to_string(i) + ".txt";
+	}
+
+	std::string const snapshot_file = "snapshot_test.bin";
+	Query query("");
+	Curves data = curves;
+	query.setCurveData(std::move(data));
+	query.setAlgorithm("light");
+	query.setNumberOfKdPivots(3);
+	query.getReady();
+	query.writeSnapshot(snapshot_file);
+
+	Query snapshot_query("");
+	snapshot_query.setAlgorithm("light");
+	snapshot_query.readSnapshot(snapshot_file);
+	std::remove(snapshot_file.c_str());
+
+	auto const& snapshot_curves = snapshot_query.getCurves();
+	TEST(snapshot_curves.size() == curves.size());
+	for (std::size_t id = 0; id < curves.size(); ++id) {
+		auto const& curve = curves[id];
+		auto const& snapshot_curve = snapshot_curves[id];
+		TEST(snapshot_curve.filename == curve.filename);
+		TEST(snapshot_curve.size() == curve.size() && !snapshot_curve.ownsStorage());
+		for (PointID i = 0; i < curve.size(); ++i) {
+			TEST(snapshot_curve[i].dist(curve[i]) == 0);
+			TEST(snapshot_curve.curve_length(0, i) == curve.curve_length(0, i));
+		}
+		auto const& extreme = curve.getExtremePoints();
+		auto const& snapshot_extreme = snapshot_curve.getExtremePoints();
+		TEST(snapshot_extreme.min_x == extreme.min_x && snapshot_extreme.max_x == extreme.max_x);
+		TEST(snapshot_extreme.min_y == extreme.min_y && snapshot_extreme.max_y == extreme.max_y);
+	}
+
+	// the same tree, so even the order of the results is the same
+	for (std::size_t i = 0; i < 20; ++i) {
+		auto curve = randomCurve(gen, 1 + gen()%30);
+		distance_t distance = 2. + i%5;
+		query.run(curve, distance);
+		snapshot_query.run(curve, distance);
+		TEST(query.getResults().front().curve_ids == snapshot_query.getResults().front().curve_ids);
+		TEST(query.getNumberOfKdCandidates() == snapshot_query.getNumberOfKdCandidates());
+	}
+}
+
+void unit_tests::testCurveCollection()
+{
+	// consecutive lines with the same name are a curve, even if another
+	// curve has a name which starts with the same characters
+	std::string const text =
+		"\n"
+		"a 1 2\n"
+		"a 1 2 extra\n"
+		"a 3 4\n"
+		"ab 5 6\n"
+		"  ab\t7 8\r\n"
+		"\n"
+		"c 0.5 -1e2\n"
+		"a 9 10";
+
+	Curves curves;
+	parser::readCurveCollection(text.data(), text.data() + text.size(), curves);
+	TEST(curves.size() == 4);
+	TEST(curves[0].filename == "a" && curves[0].size() == 2);
+	TEST(curves[0][1].x == 3 && curves[0][1].y == 4);
+	TEST(curves[1].filename == "ab" && curves[1].size() == 2);
+	TEST(curves[1][1].x == 7 && curves[1][1].y == 8);
+	TEST(curves[2].filename == "c" && curves[2].size() == 1);
+	TEST(curves[2][0].x == 0.5 && curves[2][0].y == -100);
+	TEST(curves[3].filename == "a" && curves[3].size() == 1);
+
+	// writing and reading keeps the coordinates exactly
+	std::mt19937 gen(47);
+	std::uniform_real_distribution<distance_t> coordinate(-100., 100.);
+	curves.clear();
+	for (std::size_t i = 0; i < 50; ++i) {
+		Curve curve;
+		for (std::size_t j = 0; j < 1 + i%7; ++j) {
+			curve.push_back({coordinate(gen), (j%2 == 0 ? std::round(coordinate(gen)) : coordinate(gen))});
+		}
+		curve.filename = "curve_" + std::to_string(i);
+		curves.push_back(curve);
+	}
+
+	std::string const collection_file = "collection_test.txt";
+	parser::writeCurveCollection(collection_file, curves);
+	Query query("");
+	query.readCurveCollection(collection_file);
+	std::remove(collection_file.c_str());
+
+	auto const& read_curves = query.getCurves();
+	TEST(read_curves.size() == curves.size());
+	for (std::size_t id = 0; id < curves.size(); ++id) {
+		TEST(read_curves[id].filename == curves[id].filename);
+		TEST(read_curves[id].size() == curves[id].size());
+		for (PointID i = 0; i < curves[id].size(); ++i) {
+			TEST(read_curves[id][i].dist(curves[id][i]) == 0);
+		}
+	}
+}
+
+void unit_tests::testCurveArena()
+{
+	// the first 8x8 cells of the Hilbert curve are its first 64 keys, and
+	// consecutive keys are neighboring cells
+	std::vector<std::pair<std::uint32_t, std::uint32_t>> cells(64, {8, 8});
+	for (std::uint32_t x = 0; x < 8; ++x) {
+		for (std::uint32_t y = 0; y < 8; ++y) {
+			auto const key = hilbertKey(x, y);
+			TEST(key < 64 && cells[key].first == 8);
+			cells[key] = {x, y};
+		}
+	}
+	for (std::size_t key = 1; key < cells.size(); ++key) {
+		auto const dx = std::abs(int(cells[key].first) - int(cells[key - 1].first));
+		auto const dy = std::abs(int(cells[key].second) - int(cells[key - 1].second));
+		TEST(dx + dy == 1);
+	}
+
+	std::mt19937 gen(53);
+	Curves curves;
+	for (std::size_t i = 0; i < 100; ++i) {
+		curves.push_back(randomCurve(gen, 1 + i%13, 100.));
+	}
+	Curves const original = curves;
+
+	// the curves keep their IDs and points, but use the arena
+	CurveArena arena;
+	arena.pack(curves);
+	auto check = [&](Curves const& packed) {
+		std::size_t num_points = 0;
+		for (CurveID id = 0; id < packed.size(); ++id) {
+			auto const& curve = packed[id];
+			TEST(!curve.ownsStorage() && arena.contains(curve));
+			TEST(curve.size() == original[id].size());
+			for (PointID i = 0; i < curve.size(); ++i) {
+				TEST(curve[i].dist(original[id][i]) == 0);
+				TEST(curve.curve_length(0, i) == original[id].curve_length(0, i));
+			}
+			num_points += curve.size();
+		}
+		TEST(arena.getNumberOfPoints() == num_points);
+	};
+	check(curves);
+
+	// packing again, and moving the curves, keeps them valid
+	arena.pack(curves);
+	Curves moved = std::move(curves);
+	moved.reserve(1000);
+	check(moved);
+
+	// a copy or a curve which is extended owns its points
+	Curve copy = moved[5];
+	TEST(copy.ownsStorage() && copy.size() == moved[5].size());
+	moved[7].push_back({1000., 1000.});
+	TEST(moved[7].ownsStorage() && moved[7].size() == original[7].size() + 1);
+	TEST(moved[7][0].dist(original[7][0]) == 0);
+}
+
 void unit_tests::testRangeTree()
 {
 	using Tree = RangeTree<double, int>;
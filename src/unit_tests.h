@@ -13,4 +13,19 @@ namespace unit_tests
 	void testLightCertificate();
 	void testLightCertificate(std::string curve1file, std::string curve2file, distance_t distance);
 
+	void testPrecisions();
+	void testEarlyTermination();
+	void testCalcDistance();
+	void testKnn();
+	void testDistanceMatrix();
+	void testSimilarityJoin();
+	void testPivotTable();
+	void testKdPivots();
+	void testKdTree();
+	void testDynamicIndex();
+	void testParser();
+	void testSnapshot();
+	void testCurveCollection();
+	void testCurveArena();
+
 }